@@ -0,0 +1,43 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+#include "bench_data.h"
+
+//Haplotype-first to variant-first transpose of the full panel
+void BM_bitmatrix_transpose(bench_state & S, bench_data & D) {
+	while (S.running()) D.H.H_opt_hap.transpose(D.H.H_opt_var, D.n_hap, D.O.L);
+	S.setItems(1.0 * D.n_hap * D.O.L);
+}
+
+//Het discordance between individual 0 and all others over the window, as done when selecting conditioning haplotypes
+void BM_bitmatrix_getMatchHetCount(bench_state & S, bench_data & D) {
+	int count_het = 0, match_het = 0;
+	while (S.running()) {
+		for (unsigned int i = 1 ; i < D.O.N ; i ++) {
+			D.H.H_opt_hap.getMatchHetCount(0, i, 0, D.O.L - 1, count_het, match_het);
+			bench_keep(match_het);
+		}
+	}
+	S.setItems(2.0 * (D.O.N - 1) * D.O.L);
+}
+
+BENCHMARK(BM_bitmatrix_transpose);
+BENCHMARK(BM_bitmatrix_getMatchHetCount);
@@ -0,0 +1,115 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+#include "bench_data.h"
+
+bench_data::bench_data(bench_options & _O) : O(_O) {
+	n_hap = 0;
+}
+
+bench_data::~bench_data() {
+	Kidx.clear();
+}
+
+void bench_data::generate() {
+	tac.clock();
+	rng.setSeed(O.seed);
+	n_hap = 2 * O.N + O.K;
+
+	//Founders drawn at the frequency giving the requested heterozygosity between two of them: het = 2p(1-p)
+	double freq = (1.0 - sqrt(max(0.0, 1.0 - 2.0 * min(O.het, 0.5)))) / 2.0;
+	bitmatrix F;
+	F.allocate(BENCH_FOUNDERS, O.L);
+	for (int f = 0 ; f < BENCH_FOUNDERS ; f ++) for (int l = 0 ; l < O.L ; l ++) F.set(f, l, rng.getDouble() < freq);
+
+	//Panel haplotypes as mosaics of founders
+	H.n_ind = O.N;
+	H.n_hap = n_hap;
+	H.n_site = O.L;
+	H.H_opt_hap.allocate(H.n_hap, H.n_site);
+	H.H_opt_var.allocate(H.n_site, H.n_hap);
+	for (int h = 0 ; h < n_hap ; h ++) {
+		unsigned int f = rng.getInt(BENCH_FOUNDERS);
+		for (int l = 0 ; l < O.L ; l ++) {
+			if (rng.getDouble() < 1.0 / BENCH_SEGMENT) f = rng.getInt(BENCH_FOUNDERS);
+			H.H_opt_hap.set(h, l, F.get(f, l) ^ (rng.getDouble() < BENCH_MUTATION));
+		}
+	}
+	H.transposeHaplotypes_H2V(true);
+
+	//Genotypes of the N individuals, with missing data
+	G.allocate(O.N, O.L);
+	for (int i = 0 ; i < O.N ; i ++) makeGenotype(*G.vecG[i], 2*i+0, 2*i+1);
+
+	//Variants with allele counts taken from the panel
+	for (int l = 0 ; l < O.L ; l ++) {
+		string chr = "1", id = "bench" + stb.str(l), ref = "A", alt = "C";
+		variant * v = new variant (chr, l + 1, id, ref, alt, l);
+		v->cm = l * BENCH_CM_STEP;
+		v->cref = v->calt = v->cmis = 0;
+		for (int i = 0 ; i < O.N ; i ++) {
+			if (VAR_GET_MIS(MOD2(l), G.vecG[i]->Variants[DIV2(l)])) v->cmis ++;
+			else {
+				H.H_opt_var.get(l, 2*i+0)?v->calt++:v->cref++;
+				H.H_opt_var.get(l, 2*i+1)?v->calt++:v->cref++;
+			}
+		}
+		for (int h = 2 * O.N ; h < n_hap ; h ++) H.H_opt_var.get(l, h)?v->calt++:v->cref++;
+		V.push(v);
+	}
+	M.initialise(V, 15000, n_hap);
+
+	//Conditioning haplotypes of individual 0
+	Kidx.clear();
+	for (int k = 0 ; k < O.K ; k ++) Kidx.push_back(2 * O.N + k);
+
+	vrb.bullet("Synthetic data [N=" + stb.str(O.N) + " / K=" + stb.str(O.K) + " / L=" + stb.str(O.L) + " / het=" + stb.str(O.het, 3) + " / mis=" + stb.str(O.mis, 3) + "] (" + stb.str(tac.rel_time()*1.0/1000, 2) + "s)");
+}
+
+void bench_data::makeGenotype(genotype & g, unsigned int h0, unsigned int h1) {
+	g.n_variants = O.L;
+	if (g.Variants.size() != (DIV2(O.L) + MOD2(O.L))) g.Variants.allocate(DIV2(O.L) + MOD2(O.L), 0);
+	for (int l = 0 ; l < O.L ; l ++) {
+		VAR_CLR_HAP0(MOD2(l), g.Variants[DIV2(l)]);
+		VAR_CLR_HAP1(MOD2(l), g.Variants[DIV2(l)]);
+		VAR_SET_HOM(MOD2(l), g.Variants[DIV2(l)]);
+		if (rng.getDouble() < O.mis) VAR_SET_MIS(MOD2(l), g.Variants[DIV2(l)]);
+		else {
+			bool a0 = H.H_opt_hap.get(h0, l), a1 = H.H_opt_hap.get(h1, l);
+			if (a0) VAR_SET_HAP0(MOD2(l), g.Variants[DIV2(l)]);
+			if (a1) VAR_SET_HAP1(MOD2(l), g.Variants[DIV2(l)]);
+			if (a0 != a1) VAR_SET_HET(MOD2(l), g.Variants[DIV2(l)]);
+		}
+	}
+}
+
+void bench_data::makeCoordinates(genotype & g, coordinates & C) {
+	C.start_locus = 0;
+	C.stop_locus = g.n_variants - 1;
+	C.start_segment = 0;
+	C.stop_segment = g.n_segments - 1;
+	C.start_ambiguous = 0;
+	C.stop_ambiguous = g.n_ambiguous - 1;
+	C.start_missing = 0;
+	C.stop_missing = g.n_missing - 1;
+	C.start_transition = 0;
+	C.stop_transition = g.n_transitions - 1;
+}
@@ -0,0 +1,62 @@
+/*******************************************************************************
+ * Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+#ifndef _BENCH_DATA_H
+#define _BENCH_DATA_H
+
+#include <utils/otools.h>
+
+#include <containers/haplotype_set.h>
+#include <containers/genotype_set.h>
+#include <containers/variant_map.h>
+#include <objects/hmm_parameters.h>
+#include <objects/compute_job.h>
+
+#include "bench_harness.h"
+
+#define BENCH_FOUNDERS		32		// #founder haplotypes the synthetic panel is a mosaic of
+#define BENCH_SEGMENT		200		// Average length in variants of a founder segment
+#define BENCH_MUTATION		0.002	// Rate at which a panel haplotype differs from its founder
+#define BENCH_CM_STEP		0.001	// Genetic distance between consecutive variants
+
+//Synthetic cohort: 2N+K haplotypes copied as mosaics of a few founders, so that PBWT matches and HMM paths look like real data
+class bench_data {
+public:
+	//DATA
+	bench_options & O;
+	unsigned int n_hap;			// #haplotypes in the panel [the first 2N are the genotyped individuals, the K next are used for conditioning]
+	variant_map V;
+	hmm_parameters M;
+	genotype_set G;				// Genotypes of the N individuals
+	haplotype_set H;			// Haplotypes of the N individuals followed by the conditioning haplotypes
+	vector < unsigned int > Kidx;	// Conditioning haplotypes of individual 0 in H.H_opt_hap
+
+	//CONSTRUCTOR/DESTRUCTOR
+	bench_data(bench_options &);
+	~bench_data();
+
+	//METHODS
+	void generate();
+	void makeGenotype(genotype &, unsigned int, unsigned int);	// Genotype of an individual from two haplotypes of the panel
+	void makeCoordinates(genotype &, coordinates &);			// Window spanning the whole genotype graph
+};
+
+#endif
@@ -0,0 +1,73 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+#include "bench_data.h"
+
+#define BENCH_STORAGE	5		// #MCMC iterations stored before solving
+
+//Random transition and missing probabilities, as produced by the HMM for a genotype graph
+void bench_probabilities(genotype & g, vector < double > & T, vector < float > & M) {
+	T = vector < double > (g.n_transitions, 0.0);
+	M = vector < float > (g.n_missing * HAP_NUMBER, 0.0f);
+	for (unsigned int t = 0 ; t < T.size() ; t ++) T[t] = (rng.getDouble() < 0.25)?1e-9:rng.getDouble();
+	for (unsigned int m = 0 ; m < M.size() ; m ++) M[m] = rng.getDouble();
+}
+
+//Genotype graph construction of individual 0 [items count the 2 haplotypes of the individual]
+void BM_genotype_build(bench_state & S, bench_data & D) {
+	genotype g (0);
+	D.makeGenotype(g, 0, 1);
+	while (S.running()) g.build();
+	S.setItems(2.0 * D.O.L);
+}
+
+void BM_genotype_sample(bench_state & S, bench_data & D) {
+	genotype g (0);
+	vector < double > T;
+	vector < float > M;
+	counter_rng R (D.O.seed);
+	D.makeGenotype(g, 0, 1);
+	g.build();
+	bench_probabilities(g, T, M);
+	while (S.running()) g.sample(T, M, R);
+	S.setItems(2.0 * D.O.L);
+}
+
+void BM_genotype_solve(bench_state & S, bench_data & D) {
+	genotype g (0);
+	vector < double > T;
+	vector < float > M;
+	vector < unsigned char > Backtrack, DipSampled;
+	counter_rng R (D.O.seed);
+	D.makeGenotype(g, 0, 1);
+	g.build();
+	for (int it = 0 ; it < BENCH_STORAGE ; it ++) {
+		bench_probabilities(g, T, M);
+		g.sample(T, M, R);
+		g.store(T, M);
+	}
+	while (S.running()) g.solve(Backtrack, DipSampled);
+	S.setItems(2.0 * D.O.L);
+}
+
+BENCHMARK(BM_genotype_build);
+BENCHMARK(BM_genotype_sample);
+BENCHMARK(BM_genotype_solve);
@@ -0,0 +1,114 @@
+/*******************************************************************************
+ * Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+#ifndef _BENCH_HARNESS_H
+#define _BENCH_HARNESS_H
+
+#include <utils/otools.h>
+
+#include <chrono>
+
+//Synthetic workload shared by all kernels (set from the command line)
+struct bench_options {
+	unsigned int K;			// #conditioning haplotypes in the HMM
+	unsigned int L;			// #variants in a window / genotype graph
+	unsigned int N;			// #individuals for the PBWT and bitmatrix kernels
+	double het;				// Rate of heterozygous genotypes
+	double mis;				// Rate of missing genotypes
+	double min_time;		// Minimal time spent per kernel in seconds
+	int seed;				// Seed used to generate the synthetic data
+	string filter;			// Only kernels whose name contains this string are run
+};
+
+//Timing loop of a kernel: timer runs between the first and the last call to running()
+class bench_state {
+public:
+	unsigned long n_iterations, n_done;
+	double n_items;			// #items (sites x haplotypes) processed per iteration
+	double time_total, time_paused;
+	std::chrono::steady_clock::time_point t_start, t_pause;
+
+	bench_state(unsigned long _n_iterations) {
+		n_iterations = _n_iterations;
+		n_done = 0;
+		n_items = 0.0;
+		time_total = time_paused = 0.0;
+	}
+
+	bool running() {
+		if (n_done == 0) t_start = std::chrono::steady_clock::now();
+		if (n_done ++ < n_iterations) return true;
+		time_total = std::chrono::duration < double > (std::chrono::steady_clock::now() - t_start).count();
+		return false;
+	}
+
+	//Excludes the work done in between from the timing (e.g. restoring inputs modified in place)
+	void pause() {
+		t_pause = std::chrono::steady_clock::now();
+	}
+
+	void resume() {
+		time_paused += std::chrono::duration < double > (std::chrono::steady_clock::now() - t_pause).count();
+	}
+
+	void setItems(double _n_items) {
+		n_items = _n_items;
+	}
+
+	double seconds() const {
+		return time_total - time_paused;
+	}
+};
+
+class bench_data;
+
+typedef void (*bench_function)(bench_state &, bench_data &);
+
+struct bench_case {
+	string name;
+	bench_function func;
+};
+
+inline
+vector < bench_case > & bench_registry() {
+	static vector < bench_case > registry;
+	return registry;
+}
+
+struct bench_register {
+	bench_register(string name, bench_function func) {
+		bench_case c;
+		c.name = name;
+		c.func = func;
+		bench_registry().push_back(c);
+	}
+};
+
+#define BENCHMARK(func) static bench_register bench_register_##func(#func, func);
+
+//Keeps the compiler from discarding the result of a kernel
+template < class T >
+inline
+void bench_keep(T const & value) {
+	asm volatile("" : : "r,m"(value) : "memory");
+}
+
+#endif
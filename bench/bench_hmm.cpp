@@ -0,0 +1,56 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+#include "bench_data.h"
+
+#include <models/haplotype_segment_single.h>
+#include <models/haplotype_segment_double.h>
+
+//Forward and backward passes over a window spanning the whole genotype graph of individual 0, conditioning on K haplotypes
+template < class segment >
+void bench_hmm(bench_state & S, bench_data & D) {
+	genotype g (0);
+	D.makeGenotype(g, 0, 1);
+	g.build();
+	coordinates C;
+	D.makeCoordinates(g, C);
+	bitmatrix Hbuf;
+	workspace_arena Work;
+	vector < double > T = vector < double > (g.n_transitions, 0.0);
+	vector < float > M = vector < float > (g.n_missing * HAP_NUMBER, 0.0f);
+	while (S.running()) {
+		segment HS (&g, D.H.H_opt_hap, D.Kidx, C, D.M, Hbuf, Work);
+		HS.forward();
+		bench_keep(HS.backward(T, M));
+	}
+	S.setItems(1.0 * D.O.L * D.O.K);
+}
+
+void BM_hmm_single(bench_state & S, bench_data & D) {
+	bench_hmm < haplotype_segment_single > (S, D);
+}
+
+void BM_hmm_double(bench_state & S, bench_data & D) {
+	bench_hmm < haplotype_segment_double > (S, D);
+}
+
+BENCHMARK(BM_hmm_single);
+BENCHMARK(BM_hmm_double);
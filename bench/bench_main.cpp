@@ -0,0 +1,94 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+#define _DECLARE_TOOLBOX_HERE
+#include "bench_data.h"
+
+#include <cstdio>
+
+#define BENCH_MAX_GROWTH	10.0	// Maximal growth of the iteration count between two timing runs
+
+//Runs a kernel with more and more iterations until it takes at least min_time seconds [same scheme as Google Benchmark]
+void bench_run(bench_case & c, bench_data & D) {
+	unsigned long n_iterations = 1;
+	for (;;) {
+		bench_state S (n_iterations);
+		c.func(S, D);
+		double secs = S.seconds();
+		if (secs >= D.O.min_time || n_iterations >= 1000000000UL) {
+			double ns_per_op = secs * 1e9 / n_iterations;
+			double items_per_sec = S.n_items * n_iterations / secs;
+			printf("%-32s %12lu %14.0f %14.3f\n", c.name.c_str(), n_iterations, ns_per_op, items_per_sec * 1e-6);
+			fflush(stdout);
+			return;
+		}
+		double growth = (secs > 0.0)?(1.4 * D.O.min_time / secs):BENCH_MAX_GROWTH;
+		growth = max(min(growth, BENCH_MAX_GROWTH), 2.0);
+		n_iterations = (unsigned long)ceil(n_iterations * growth);
+	}
+}
+
+int main(int argc, char ** argv) {
+	bench_options O;
+	bpo::options_description descriptions ("Kernel microbenchmarks");
+	descriptions.add_options()
+			("help", "Produce help message")
+			("seed", bpo::value<int>()->default_value(15052011), "Seed of the synthetic data")
+			("K", bpo::value<unsigned int>()->default_value(1000), "Number of conditioning haplotypes in the HMM")
+			("L", bpo::value<unsigned int>()->default_value(2000), "Number of variants in the window")
+			("N", bpo::value<unsigned int>()->default_value(1000), "Number of individuals for the PBWT and bitmatrix kernels")
+			("het", bpo::value<double>()->default_value(0.05), "Heterozygosity [between two haplotypes of the synthetic panel]")
+			("mis", bpo::value<double>()->default_value(0.01), "Rate of missing genotypes")
+			("min-time", bpo::value<double>()->default_value(0.5), "Minimal time in seconds spent per kernel")
+			("filter", bpo::value<string>()->default_value(""), "Only run kernels whose name contains this string");
+
+	bpo::variables_map options;
+	try {
+		bpo::store(bpo::command_line_parser(argc, argv).options(descriptions).run(), options);
+		bpo::notify(options);
+	} catch ( const boost::program_options::error& e ) { cerr << "Error parsing command line arguments: " << string(e.what()) << endl; exit(0); }
+
+	if (options.count("help")) { cout << descriptions << endl; exit(0); }
+
+	O.seed = options["seed"].as < int > ();
+	O.K = options["K"].as < unsigned int > ();
+	O.L = options["L"].as < unsigned int > ();
+	O.N = options["N"].as < unsigned int > ();
+	O.het = options["het"].as < double > ();
+	O.mis = options["mis"].as < double > ();
+	O.min_time = options["min-time"].as < double > ();
+	O.filter = options["filter"].as < string > ();
+	if (O.K < 2 || O.L < 2 || O.N < 2) vrb.error("--K, --L and --N need to be at least 2");
+	if (O.het < 0.0 || O.het > 0.5) vrb.error("--het needs to be in [0,0.5]");
+	if (O.mis < 0.0 || O.mis >= 1.0) vrb.error("--mis needs to be in [0,1)");
+
+	vrb.title("Generating synthetic data");
+	bench_data D (O);
+	D.generate();
+
+	//Kernels report their own timings on screen: silenced from here
+	vrb.title("Running kernels [items = sites x haplotypes]");
+	vrb.set_silent();
+	printf("%-32s %12s %14s %14s\n", "Kernel", "Iterations", "ns/op", "Mitems/s");
+	for (int c = 0 ; c < bench_registry().size() ; c ++)
+		if (bench_registry()[c].name.find(O.filter) != string::npos) bench_run(bench_registry()[c], D);
+	return 0;
+}
@@ -0,0 +1,53 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+#include "bench_data.h"
+
+#include <modules/pbwt_solver.h>
+
+//Selection of the PBWT neighbours of all individuals at the evaluated variants
+void BM_pbwt_select(bench_state & S, bench_data & D) {
+	haplotype_set & H = D.H;
+	H.parametrizePBWT(4, 0.02, 2, 0.5, 1);
+	H.pbwt_evaluated.clear();
+	H.pbwt_cm.clear();
+	H.pbwt_grp.clear();
+	H.initializePBWTmapping(D.V);
+	H.allocatePBWTarrays();
+	while (S.running()) H.selectPBWTarrays();
+	S.setItems(1.0 * H.pbwt_evaluated.size() * D.n_hap);
+}
+
+//Initial phasing by PBWT sweep [the sweep overwrites the hets in the panel, which are restored out of the timing]
+void BM_pbwt_sweep(bench_state & S, bench_data & D) {
+	bitmatrix Hsaved = D.H.H_opt_var;
+	pbwt_solver solver (D.H);
+	while (S.running()) {
+		solver.sweep(D.G);
+		S.pause();
+		memcpy(D.H.H_opt_var.bytes, Hsaved.bytes, Hsaved.n_bytes);
+		S.resume();
+	}
+	S.setItems(1.0 * D.O.L * D.n_hap);
+}
+
+BENCHMARK(BM_pbwt_select);
+BENCHMARK(BM_pbwt_sweep);
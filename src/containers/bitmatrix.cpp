@@ -27,11 +27,37 @@ bitmatrix::bitmatrix() {
 	n_rows = 0;
 	n_cols = 0;
 	n_bytes = 0;
+	n_capacity = 0;
 	bytes = NULL;
 }
 
+bitmatrix::bitmatrix(const bitmatrix & BM) {
+	n_rows = 0;
+	n_cols = 0;
+	n_bytes = 0;
+	n_capacity = 0;
+	bytes = NULL;
+	*this = BM;
+}
+
+bitmatrix & bitmatrix::operator = (const bitmatrix & BM) {
+	if (this == &BM) return *this;
+	if (bytes != NULL) free(bytes);
+	n_rows = BM.n_rows;
+	n_cols = BM.n_cols;
+	n_bytes = BM.n_bytes;
+	n_capacity = BM.n_bytes;
+	bytes = NULL;
+	if (n_bytes) {
+		bytes = (unsigned char*)malloc(n_bytes*sizeof(unsigned char));
+		memcpy(bytes, BM.bytes, n_bytes);
+	}
+	return *this;
+}
+
 bitmatrix::~bitmatrix() {
 	n_bytes = 0;
+	n_capacity = 0;
 	if (bytes != NULL) free(bytes);
 }
 
@@ -42,6 +68,7 @@ int bitmatrix::subset(bitmatrix & BM, vector < unsigned int > rows, unsigned int
 	unsigned long n_bytes_per_row = row_end - row_start + 1;
 	n_cols = n_bytes_per_row * 8;
 	n_bytes = n_bytes_per_row * n_rows;
+	n_capacity = n_bytes;
 	bytes = (unsigned char*)malloc(n_bytes*sizeof(unsigned char));
 	unsigned long offset_addr = 0;
 	for (int r = 0 ; r < rows.size() ; r ++) {
@@ -78,6 +105,7 @@ void bitmatrix::allocate(unsigned int nrow, unsigned int ncol) {
 	n_rows = nrow + ((nrow%8)?(8-(nrow%8)):0);
 	n_cols = ncol + ((ncol%8)?(8-(ncol%8)):0);
 	n_bytes = (n_cols/8) * (unsigned long)n_rows;
+	n_capacity = n_bytes;
 	bytes = (unsigned char*)malloc(n_bytes*sizeof(unsigned char));
 	memset(bytes, 0, n_bytes);
 }
@@ -86,9 +114,48 @@ void bitmatrix::allocateFast(unsigned int nrow, unsigned int ncol) {
 	n_rows = nrow + ((nrow%8)?(8-(nrow%8)):0);
 	n_cols = ncol + ((ncol%8)?(8-(ncol%8)):0);
 	n_bytes = (n_cols/8) * (unsigned long)n_rows;
+	n_capacity = n_bytes;
 	bytes = (unsigned char*)malloc(n_bytes*sizeof(unsigned char));
 }
 
+//Same as allocateFast, but keeps the current buffer when it is large enough (reused across windows)
+void bitmatrix::reallocateFast(unsigned int nrow, unsigned int ncol) {
+	n_rows = nrow + ((nrow%8)?(8-(nrow%8)):0);
+	n_cols = ncol + ((ncol%8)?(8-(ncol%8)):0);
+	n_bytes = (n_cols/8) * (unsigned long)n_rows;
+	if (n_bytes > n_capacity) {
+		if (bytes != NULL) free(bytes);
+		n_capacity = n_bytes + n_bytes / 4;
+		bytes = (unsigned char*)malloc(n_capacity*sizeof(unsigned char));
+	}
+}
+
+//Fused subset + transpose: builds the variant-major tile [cols col_from..col_to of BM] x [rows of BM] in a single pass over 8x8 bit blocks
+int bitmatrix::gather(bitmatrix & BM, vector < unsigned int > & rows, unsigned int col_from, unsigned int col_to) {
+	unsigned long n_bytes_per_row = col_to/8 - col_from/8 + 1;
+	reallocateFast(n_bytes_per_row * 8, rows.size());
+	unsigned long targetAddr;
+	const unsigned char * source [8];
+	union { unsigned int x[2]; unsigned char b[8]; } m4x8d;
+	for (unsigned int row = 0; row < n_cols; row += 8) {
+		unsigned int n_valid = min((unsigned int)rows.size() - row, 8U);
+		for (unsigned int i = 0; i < n_valid; i++) source[i] = &BM.bytes[((unsigned long)rows[row+i]) * (BM.n_cols/8) + col_from/8];
+		for (unsigned int i = n_valid; i < 8; i++) m4x8d.b[7 - i] = 0;
+		for (unsigned long cb = 0, col = 0; cb < n_bytes_per_row; cb ++, col += 8) {
+			for (unsigned int i = 0; i < n_valid; i++) m4x8d.b[7 - i] = source[i][cb];
+			for (unsigned int i = 0; i < 7; i++) {
+				targetAddr = ((col+i) * ((unsigned long)(n_cols/8)) + (row) / 8);
+				bytes[targetAddr]  = static_cast<unsigned char>(abracadabra(m4x8d.x[1] & (0x80808080 >> i), (0x02040810 << i)) & 0x0f) << 4;
+				bytes[targetAddr] |= static_cast<unsigned char>(abracadabra(m4x8d.x[0] & (0x80808080 >> i), (0x02040810 << i)) & 0x0f) << 0;
+			}
+			targetAddr = ((col+7) * ((unsigned long)(n_cols/8)) + (row) / 8);
+			bytes[targetAddr]  = static_cast<unsigned char>(abracadabra((m4x8d.x[1] << 7) & (0x80808080 >> 0), (0x02040810 << 0)) & 0x0f) << 4;
+			bytes[targetAddr] |= static_cast<unsigned char>(abracadabra((m4x8d.x[0] << 7) & (0x80808080 >> 0), (0x02040810 << 0)) & 0x0f) << 0;
+		}
+	}
+	return col_from % 8;
+}
+
 
 /*
  * This algorithm for transposing bit matrices is adapted from the code of Timur Kristóf
@@ -30,16 +30,20 @@ inline static unsigned int abracadabra(const unsigned int &i1, const unsigned in
 
 class bitmatrix	{
 public:
-	unsigned long int n_bytes, n_cols, n_rows, startAddr;
+	unsigned long int n_bytes, n_cols, n_rows, startAddr, n_capacity;
 	unsigned char * bytes;
 
 	bitmatrix();
+	bitmatrix(const bitmatrix &);
+	bitmatrix & operator = (const bitmatrix &);
 	~bitmatrix();
 
 	int subset(bitmatrix & BM, vector < unsigned int > rows, unsigned int col_from, unsigned int col_to);
+	int gather(bitmatrix & BM, vector < unsigned int > & rows, unsigned int col_from, unsigned int col_to);
 	void getMatchHetCount(unsigned int i0, unsigned int i1, unsigned int start, unsigned int stop, int & c1, int & m1);
 	void allocate(unsigned int nrow, unsigned int ncol);
 	void allocateFast(unsigned int nrow, unsigned int ncol);
+	void reallocateFast(unsigned int nrow, unsigned int ncol);
 	void set(unsigned int row, unsigned int col, unsigned char bit);
 	unsigned char get(unsigned int row, unsigned int col);
 	void transpose(bitmatrix & BM, unsigned int _max_row, unsigned int _max_col);
@@ -21,18 +21,68 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include <containers/genotype_set.h>
 
+#include <malloc.h>
+
 genotype_set::genotype_set() {
 	n_site = 0;
 	n_ind = 0;
+	prob_bits = 32;
 }
 
 genotype_set::~genotype_set() {
-	for (int i = 0 ; i< vecG.size() ; i ++) delete vecG[i];
 	vecG.clear();
+	pool.clear();
 	n_site = 0;
 	n_ind = 0;
 }
 
+void genotype_set::allocate(unsigned int _n_ind, unsigned int _n_site) {
+	n_ind = _n_ind;
+	n_site = _n_site;
+	unsigned long n_bytes = DIV2(n_site) + MOD2(n_site);
+	arenaVariants = vector < unsigned char > (n_ind * n_bytes, 0);
+	vecG = vector < genotype * > (n_ind, NULL);
+	pool.clear();
+	pool.reserve(n_ind);
+	for (int i = 0 ; i < n_ind ; i ++) {
+		pool.emplace_back(i);
+		vecG[i] = &pool[i];
+		vecG[i]->n_variants = n_site;
+		vecG[i]->Variants.view(&arenaVariants[i * n_bytes], n_bytes);
+	}
+}
+
+void genotype_set::compact() {
+	tac.clock();
+	unsigned long rss_before = currentRSS(), n_bytes = arenaVariants.size();
+	n_bytes += compactArena(arenaAmbiguous, offsetAmbiguous, &genotype::Ambiguous);
+	n_bytes += compactArena(arenaDiplotypes, offsetDiplotypes, &genotype::Diplotypes);
+	n_bytes += compactArena(arenaLengths, offsetLengths, &genotype::Lengths);
+	n_bytes += compactArena(arenaProbStored, offsetProbStored, &genotype::ProbStored);
+	n_bytes += compactArena(arenaProbMissing, offsetProbMissing, &genotype::ProbMissing);
+	malloc_trim(0);
+	unsigned long rss_after = currentRSS();
+	vrb.bullet("HAP compaction [arenas=" + stb.str(n_bytes / 1048576.0, 1) + "Mb / RSS=" + stb.str(rss_before / 1048576.0, 1) + "Mb -> " + stb.str(rss_after / 1048576.0, 1) + "Mb] (" + stb.str(tac.rel_time()*1.0/1000, 2) + "s)");
+}
+
+void genotype_set::quantize(unsigned int bits) {
+	tac.clock();
+	unsigned long rss_before = currentRSS();
+	double max_error_trans = 0.0, max_error_miss = 0.0;
+	offsetProbQuantized = vector < unsigned long > (n_ind + 1, 0);
+	for (int i = 0 ; i < n_ind ; i ++) offsetProbQuantized[i+1] = offsetProbQuantized[i] + (vecG[i]->n_stored_transitionProbs + vecG[i]->n_missing * HAP_NUMBER) * (bits / 8);
+	arenaProbQuantized = vector < unsigned char > (offsetProbQuantized[n_ind], 0);
+	for (int i = 0 ; i < n_ind ; i ++) vecG[i]->quantize(bits, arenaProbQuantized.data() + offsetProbQuantized[i], max_error_trans, max_error_miss);
+	vector < float > ().swap(arenaProbStored);
+	vector < float > ().swap(arenaProbMissing);
+	vector < unsigned long > ().swap(offsetProbStored);
+	vector < unsigned long > ().swap(offsetProbMissing);
+	malloc_trim(0);
+	prob_bits = bits;
+	unsigned long rss_after = currentRSS();
+	vrb.bullet("HAP quantization [bits=" + stb.str(bits) + " / max error=" + stb.str(max_error_trans * 100, 2) + "% (trans) " + stb.str(max_error_miss, 4) + " (miss) / RSS=" + stb.str(rss_before / 1048576.0, 1) + "Mb -> " + stb.str(rss_after / 1048576.0, 1) + "Mb] (" + stb.str(tac.rel_time()*1.0/1000, 2) + "s)");
+}
+
 void genotype_set::imputeMonomorphic(variant_map & V) {
 	for (unsigned int v = 0 ; v < V.size() ; v ++) {
 		if (V.vec_pos[v]->isMonomorphic()) {
@@ -76,9 +126,3 @@ unsigned long genotype_set::numberOfSegments() {
 void genotype_set::masking() {
 	for (int i = 0 ; i < n_ind ; i ++) vecG[i]->mask();
 }
-
-void genotype_set::solve() {
-	tac.clock();
-	for (int i = 0 ; i < vecG.size() ; i ++) vecG[i]->solve();
-	vrb.bullet("HAP solving (" + stb.str(tac.rel_time()*1.0/1000, 2) + "s)");
-}
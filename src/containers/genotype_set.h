@@ -31,19 +31,43 @@ class genotype_set {
 public:
 	//DATA
 	int n_site, n_ind;					//Number of variants, number of individuals
+	unsigned int prob_bits;				//Precision of stored phase probabilities [32: float, 16 or 8: quantized]
 	vector < genotype * > vecG;			//Vector of genotype graphs
+	vector < genotype > pool;			//Genotype graphs stored contiguously (vecG points into it)
+
+	//ARENAS [per-sample data stored contiguously, genotype graphs hold views into them]
+	vector < unsigned char > arenaVariants, arenaAmbiguous;
+	vector < unsigned long > arenaDiplotypes;
+	vector < unsigned short > arenaLengths;
+	vector < float > arenaProbStored, arenaProbMissing;
+	vector < unsigned char > arenaProbQuantized;
+	vector < unsigned long > offsetAmbiguous, offsetDiplotypes, offsetLengths, offsetProbStored, offsetProbMissing, offsetProbQuantized;	//Per-sample offsets in the arenas (n_ind+1 entries)
 
 	//CONSTRUCTOR/DESTRUCTOR
 	genotype_set();
 	~genotype_set();
 
 	//METHODS
+	void allocate(unsigned int, unsigned int);	//Allocate genotype graphs and the Variants arena for a given number of individuals and variants
+	void compact();								//Pack per-sample data into contiguous arenas and report resident memory before and after
+	void quantize(unsigned int);				//Quantize stored phase probabilities to 8 or 16 bits once the last main iteration is done
+	template < class T > unsigned long compactArena(vector < T > &, vector < unsigned long > &, buffer_view < T > genotype::*);
 	void imputeMonomorphic(variant_map &);		//Impute to REF monomorphic variants
 	unsigned int largestNumberOfTransitions();	//Get the number of transitions in the larger genotype graph. Used to initialize memory space for multi-threading.
 	unsigned int largestNumberOfMissings();	//Get the number of transitions in the larger genotype graph. Used to initialize memory space for multi-threading.
 	unsigned long numberOfSegments();			//Total number of segments across all genotype graphs (used for verbose).
 	void masking();								//Call function mask for all genotype graphs
-	void solve();								//Call function solve for all genotype graphs
 };
 
+template < class T >
+unsigned long genotype_set::compactArena(vector < T > & arena, vector < unsigned long > & offsets, buffer_view < T > genotype::* field) {
+	offsets = vector < unsigned long > (n_ind + 1, 0);
+	for (int i = 0 ; i < n_ind ; i ++) offsets[i+1] = offsets[i] + (vecG[i]->*field).size();
+	vector < T > packed = vector < T > (offsets[n_ind]);
+	for (int i = 0 ; i < n_ind ; i ++) if (offsets[i+1] > offsets[i]) memcpy(&packed[offsets[i]], (vecG[i]->*field).data(), (offsets[i+1] - offsets[i]) * sizeof(T));
+	arena.swap(packed);
+	for (int i = 0 ; i < n_ind ; i ++) (vecG[i]->*field).view(arena.data() + offsets[i], offsets[i+1] - offsets[i]);
+	return arena.size() * sizeof(T);
+}
+
 #endif
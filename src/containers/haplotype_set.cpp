@@ -21,6 +21,37 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include <containers/haplotype_set.h>
 
+//Decoding of one byte of genotype::Variants (2 variants) into 2 haplotype bits [first variant in bit 1, second in bit 0]
+struct variant_byte_lut {
+	unsigned char hap0[256], hap1[256], update[256], het[256];
+
+	variant_byte_lut() {
+		for (unsigned int x = 0 ; x < 256 ; x ++) {
+			unsigned char v = x;
+			hap0[x] = (VAR_GET_HAP0(0, v) << 1) | VAR_GET_HAP0(1, v);
+			hap1[x] = (VAR_GET_HAP1(0, v) << 1) | VAR_GET_HAP1(1, v);
+			update[x] = ((VAR_GET_HET(0, v) || VAR_GET_MIS(0, v)) << 1) | (VAR_GET_HET(1, v) || VAR_GET_MIS(1, v));
+			het[x] = (VAR_GET_HET(0, v) << 1) | VAR_GET_HET(1, v);
+		}
+	}
+};
+
+static const variant_byte_lut vlut;
+
+struct update_range {
+	haplotype_set * H;
+	genotype_set * G;
+	unsigned int ind_from, ind_to;
+	bool first_time;
+};
+
+void * updateHaplotypes_callback(void * ptr) {
+	update_range * R = static_cast< update_range * >( ptr );
+	R->H->updateHaplotypes(*R->G, R->ind_from, R->ind_to, R->first_time);
+	pthread_exit(NULL);
+	return NULL;
+}
+
 haplotype_set::haplotype_set() {
 	clear();
 }
@@ -93,17 +124,74 @@ void haplotype_set::allocatePBWTarrays() {
 
 void haplotype_set::updateHaplotypes(genotype_set & G, bool first_time) {
 	tac.clock();
-	for (unsigned int i = 0 ; i < G.n_ind ; i ++) {
-		for (unsigned int v = 0 ; v < n_site ; v ++) {
-			if (first_time || (VAR_GET_HET(MOD2(v), G.vecG[i]->Variants[DIV2(v)])) || (VAR_GET_MIS(MOD2(v), G.vecG[i]->Variants[DIV2(v)]))) {
+	unsigned int n_thread = min((unsigned long)max(nthreads, 1U), (unsigned long)G.n_ind);
+	phase_changes = vector < unsigned int > (G.n_ind, 0);
+	phase_hets = vector < unsigned int > (G.n_ind, 0);
+	if (n_thread > 1) {
+		vector < pthread_t > id_workers = vector < pthread_t > (n_thread);
+		vector < update_range > ranges = vector < update_range > (n_thread);
+		for (unsigned int t = 0 ; t < n_thread ; t++) {
+			ranges[t].H = this;
+			ranges[t].G = &G;
+			ranges[t].ind_from = (t * (unsigned long)G.n_ind) / n_thread;
+			ranges[t].ind_to = ((t + 1) * (unsigned long)G.n_ind) / n_thread;
+			ranges[t].first_time = first_time;
+			pthread_create( &id_workers[t] , NULL, updateHaplotypes_callback, static_cast<void *>(&ranges[t]));
+		}
+		for (unsigned int t = 0 ; t < n_thread ; t++) pthread_join( id_workers[t] , NULL);
+	} else updateHaplotypes(G, 0, G.n_ind, first_time);
+	vrb.bullet("HAP update (" + stb.str(tac.rel_time()*1.0/1000, 2) + "s)");
+}
+
+//Rows of distinct individuals never share a byte of H_opt_hap, so disjoint ranges can be processed concurrently
+//Phase changes are counted as switches in the orientation [old vs new hap0] between consecutive hets of an individual
+void haplotype_set::updateHaplotypes(genotype_set & G, unsigned int ind_from, unsigned int ind_to, bool first_time) {
+	unsigned long n_row_bytes = H_opt_hap.n_cols / 8, n_full_bytes = n_site / 8;
+	for (unsigned int i = ind_from ; i < ind_to ; i ++) {
+		const unsigned char * var = G.vecG[i]->Variants.data();
+		unsigned char * row0 = H_opt_hap.bytes + (2UL*i+0) * n_row_bytes;
+		unsigned char * row1 = H_opt_hap.bytes + (2UL*i+1) * n_row_bytes;
+		unsigned int n_changes = 0, n_hets = 0;
+		int prev = -1;
+
+		//8 variants [4 bytes of Variants] per byte of H_opt_hap
+		for (unsigned long b = 0 ; b < n_full_bytes ; b ++, var += 4) {
+			unsigned char h0 = (vlut.hap0[var[0]] << 6) | (vlut.hap0[var[1]] << 4) | (vlut.hap0[var[2]] << 2) | vlut.hap0[var[3]];
+			unsigned char h1 = (vlut.hap1[var[0]] << 6) | (vlut.hap1[var[1]] << 4) | (vlut.hap1[var[2]] << 2) | vlut.hap1[var[3]];
+			unsigned char upd = first_time?255:((vlut.update[var[0]] << 6) | (vlut.update[var[1]] << 4) | (vlut.update[var[2]] << 2) | vlut.update[var[3]]);
+			unsigned char hm = first_time?0:((vlut.het[var[0]] << 6) | (vlut.het[var[1]] << 4) | (vlut.het[var[2]] << 2) | vlut.het[var[3]]);
+			if (hm) {
+				unsigned char flip = (row0[b] ^ h0) & hm;
+				for (int k = 7 ; k >= 0 ; k --) if ((hm >> k) & 1) {
+					int o = (flip >> k) & 1;
+					n_changes += (prev >= 0 && o != prev);
+					prev = o;
+					n_hets ++;
+				}
+			}
+			row0[b] = (row0[b] & ~upd) | (h0 & upd);
+			row1[b] = (row1[b] & ~upd) | (h1 & upd);
+		}
+
+		//Remaining variants
+		for (unsigned int v = n_full_bytes * 8 ; v < n_site ; v ++) {
+			bool het = VAR_GET_HET(MOD2(v), G.vecG[i]->Variants[DIV2(v)]);
+			if (first_time || het || (VAR_GET_MIS(MOD2(v), G.vecG[i]->Variants[DIV2(v)]))) {
 				bool a0 = VAR_GET_HAP0(MOD2(v), G.vecG[i]->Variants[DIV2(v)]);
 				bool a1 = VAR_GET_HAP1(MOD2(v), G.vecG[i]->Variants[DIV2(v)]);
+				if (!first_time && het) {
+					int o = (H_opt_hap.get(2*i+0, v) != a0);
+					n_changes += (prev >= 0 && o != prev);
+					prev = o;
+					n_hets ++;
+				}
 				H_opt_hap.set(2*i+0, v, a0);
 				H_opt_hap.set(2*i+1, v, a1);
 			}
 		}
+		phase_changes[i] = n_changes;
+		phase_hets[i] = n_hets;
 	}
-	vrb.bullet("HAP update (" + stb.str(tac.rel_time()*1.0/1000, 2) + "s)");
 }
 
 void haplotype_set::transposeHaplotypes_H2V(bool full) {
@@ -140,6 +228,17 @@ void haplotype_set::transposePBWTarrays() {
 	vrb.bullet("C2H transpose (" + stb.str(tac.rel_time()*1.0/1000, 2) + "s)");
 }
 
+//Distinct PBWT neighbours of both haplotypes of an individual over all stored loci [after transposePBWTarrays]
+void haplotype_set::getPBWTneighbours(int ind, vector < int > & N) {
+	unsigned long addr_offset = pbwt_nstored * n_ind * 2UL;
+	N.clear();
+	for (int d = 0 ; d < pbwt_depth ; d ++)
+		for (int h = 2 * ind ; h < 2 * ind + 2 ; h ++)
+			N.insert(N.end(), pbwt_neighbours.begin() + d * addr_offset + h * pbwt_nstored, pbwt_neighbours.begin() + d * addr_offset + (h + 1) * pbwt_nstored);
+	sort(N.begin(), N.end());
+	N.erase(unique(N.begin(), N.end()), N.end());
+}
+
 void haplotype_set::selectPBWTarrays() {
 	tac.clock();
 	if (bannedPairs.size() == 0) bannedPairs = vector < vector < IBD2track > > (n_ind);
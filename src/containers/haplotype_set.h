@@ -79,6 +79,10 @@ public:
 	vector < int > pbwt_darray;		//PBWT divergence array
 	vector < int > pbwt_neighbours; //Closest neighbours
 
+	//Convergence of the haplotypes [last update]
+	vector < unsigned int > phase_changes;	// #changes of relative phase between consecutive hets per individual
+	vector < unsigned int > phase_hets;		// #hets per individual
+
 	//PBWT IBD2 protect
 	vector < vector < IBD2track > > bannedPairs;
 
@@ -94,6 +98,7 @@ public:
 	void allocatePBWTarrays();
 	void selectPBWTarrays();
 	void transposePBWTarrays();
+	void getPBWTneighbours(int, vector < int > &);
 
 	//IBD2 routines
 	//void searchIBD2matching(genotype_set & G, variant_map & V, double minLengthIBDtrack, double windowSize, double ibd2_maf, double ibd2_mdr, int ibd2_count);
@@ -103,6 +108,7 @@ public:
 
 	//Haplotype routines
 	void updateHaplotypes(genotype_set & G, bool first_time = false);
+	void updateHaplotypes(genotype_set & G, unsigned int, unsigned int, bool);
 	void transposeHaplotypes_H2V(bool full);
 	void transposeHaplotypes_V2H(bool full);
 };
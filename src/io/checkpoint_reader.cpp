@@ -0,0 +1,171 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+#include <io/checkpoint_reader.h>
+
+#include <zlib.h>
+
+checkpoint_reader::checkpoint_reader(genotype_set & _G, haplotype_set & _H) : G(_G), H(_H) {
+}
+
+checkpoint_reader::~checkpoint_reader() {
+}
+
+void checkpoint_reader::string_read(istream & fin, string & x) {
+	vector < char > buffer;
+	array_read(fin, buffer);
+	x = string(buffer.begin(), buffer.end());
+}
+
+void checkpoint_reader::genotype_read(istream & fin, genotype * g) {
+	// integers
+	fin.read(reinterpret_cast<char*>(&g->n_segments), sizeof(g->n_segments));
+	fin.read(reinterpret_cast<char*>(&g->n_ambiguous), sizeof(g->n_ambiguous));
+	fin.read(reinterpret_cast<char*>(&g->n_missing), sizeof(g->n_missing));
+	fin.read(reinterpret_cast<char*>(&g->n_transitions), sizeof(g->n_transitions));
+	fin.read(reinterpret_cast<char*>(&g->n_stored_transitionProbs), sizeof(g->n_stored_transitionProbs));
+	fin.read(reinterpret_cast<char*>(&g->n_storage_events), sizeof(g->n_storage_events));
+	fin.read(reinterpret_cast<char*>(&g->double_precision), sizeof(g->double_precision));
+	// vectors [Variants is a view into the arena of genotype_set and keeps its size]
+	vector < unsigned char > variants, ambiguous, mask;
+	vector < unsigned long > diplotypes;
+	vector < unsigned short > lengths;
+	vector < float > stored, missing;
+	array_read(fin, variants);
+	if (variants.size() != g->Variants.size()) vrb.error("Checkpoint does not match the genotypes of [" + g->name + "]");
+	memcpy(g->Variants.data(), variants.data(), variants.size());
+	array_read(fin, ambiguous);
+	array_read(fin, diplotypes);
+	array_read(fin, lengths);
+	g->Ambiguous = ambiguous;
+	g->Diplotypes = diplotypes;
+	g->Lengths = lengths;
+	// accumulated phase probabilities
+	unsigned long n_mask = 0;
+	fin.read(reinterpret_cast<char*>(&n_mask), sizeof(n_mask));
+	array_read(fin, mask);
+	g->ProbMask.clear();
+	if (n_mask > 0 && mask.size() == ((n_mask + 7) >> 3)) {
+		g->ProbMask.allocate(n_mask, false);
+		for (unsigned long t = 0 ; t < n_mask ; t ++) if ((mask[t >> 3] >> (t & 7)) & 1) g->ProbMask.set(t);
+		g->ProbMask.buildRank();
+	}
+	array_read(fin, stored);
+	array_read(fin, missing);
+	g->ProbStored = stored;
+	g->ProbMissing = missing;
+}
+
+void checkpoint_reader::readCheckpoint(string fname, mcmc_state & S) {
+	tac.clock();
+	ifstream fd (fname.c_str(), std::ios::in | std::ios::binary);
+	if (fd.fail()) vrb.error("Impossible to open checkpoint file [" + fname + "]");
+
+	//Header and compressed state
+	char magic [8];
+	unsigned int version = 0;
+	unsigned long usize = 0, csize = 0;
+	fd.read(magic, 8);
+	fd.read(reinterpret_cast<char*>(&version), sizeof(version));
+	if (fd.fail() || strncmp(magic, CHECKPOINT_MAGIC, 8) != 0) vrb.error("File [" + fname + "] is not a SHAPEIT checkpoint");
+	if (version != CHECKPOINT_VERSION) vrb.error("Checkpoint version [" + stb.str(version) + "] is not supported by this version of SHAPEIT");
+	fd.read(reinterpret_cast<char*>(&usize), sizeof(usize));
+	fd.read(reinterpret_cast<char*>(&csize), sizeof(csize));
+	vector < unsigned char > zbuffer = vector < unsigned char > (csize);
+	fd.read(reinterpret_cast<char*>(zbuffer.data()), csize);
+	if (fd.fail()) vrb.error("Checkpoint file [" + fname + "] is truncated");
+	fd.close();
+	string buffer = string(usize, 0);
+	uLongf zsize = usize;
+	if (uncompress(reinterpret_cast<Bytef*>(&buffer[0]), &zsize, zbuffer.data(), csize) != Z_OK || zsize != usize) vrb.error("Checkpoint file [" + fname + "] is corrupted");
+	vector < unsigned char > ().swap(zbuffer);
+	istringstream fin (buffer);
+
+	//Dimensions and samples
+	unsigned long n_ind = 0, n_site = 0, n_hap = 0, n_row_bytes = 0;
+	fin.read(reinterpret_cast<char*>(&n_ind), sizeof(n_ind));
+	fin.read(reinterpret_cast<char*>(&n_site), sizeof(n_site));
+	fin.read(reinterpret_cast<char*>(&n_hap), sizeof(n_hap));
+	fin.read(reinterpret_cast<char*>(&n_row_bytes), sizeof(n_row_bytes));
+	if (n_ind != G.n_ind || n_site != H.n_site || n_hap != H.n_hap || n_row_bytes != H.H_opt_hap.n_cols / 8)
+		vrb.error("Checkpoint dimensions [N=" + stb.str(n_ind) + " / L=" + stb.str(n_site) + "] do not match input data [N=" + stb.str(G.n_ind) + " / L=" + stb.str(H.n_site) + "]");
+	for (int i = 0 ; i < G.n_ind ; i ++) {
+		string name;
+		string_read(fin, name);
+		if (name != G.vecG[i]->name) vrb.error("Checkpoint samples do not match input data [" + name + "] vs [" + G.vecG[i]->name + "]");
+	}
+
+	//MCMC cursor
+	vector < unsigned char > frozen;
+	unsigned long n_frozen_neighbours = 0;
+	string_read(fin, S.scheme);
+	fin.read(reinterpret_cast<char*>(&S.stage), sizeof(S.stage));
+	fin.read(reinterpret_cast<char*>(&S.iter), sizeof(S.iter));
+	fin.read(reinterpret_cast<char*>(&S.current_iteration), sizeof(S.current_iteration));
+	fin.read(reinterpret_cast<char*>(&S.n_main_iterations), sizeof(S.n_main_iterations));
+	fin.read(reinterpret_cast<char*>(&S.n_old_segments), sizeof(S.n_old_segments));
+	fin.read(reinterpret_cast<char*>(&S.n_prev_segments), sizeof(S.n_prev_segments));
+	fin.read(reinterpret_cast<char*>(&S.skip_to_main), sizeof(S.skip_to_main));
+	array_read(fin, S.iteration_done);
+	array_read(fin, frozen);
+	S.frozen = vector < bool > (frozen.begin(), frozen.end());
+	array_read(fin, S.stable_iterations);
+	array_read(fin, S.stable_transitions);
+	fin.read(reinterpret_cast<char*>(&n_frozen_neighbours), sizeof(n_frozen_neighbours));
+	if (fin.fail() || n_frozen_neighbours > n_ind) vrb.error("Checkpoint file [" + fname + "] is corrupted");
+	S.frozen_neighbours = vector < vector < int > > (n_frozen_neighbours);
+	for (int i = 0 ; i < n_frozen_neighbours ; i ++) array_read(fin, S.frozen_neighbours[i]);
+
+	//Haplotypes of the main samples
+	vector < unsigned char > haplotypes;
+	array_read(fin, haplotypes);
+	if (haplotypes.size() != 2UL * n_ind * n_row_bytes) vrb.error("Checkpoint file [" + fname + "] is corrupted");
+	memcpy(H.H_opt_hap.bytes, haplotypes.data(), haplotypes.size());
+	vector < unsigned char > ().swap(haplotypes);
+
+	//IBD2 constraints
+	unsigned long n_banned = 0;
+	fin.read(reinterpret_cast<char*>(&n_banned), sizeof(n_banned));
+	if (fin.fail() || n_banned > n_ind) vrb.error("Checkpoint file [" + fname + "] is corrupted");
+	H.bannedPairs = vector < vector < IBD2track > > (n_banned);
+	for (int i = 0 ; i < n_banned ; i ++) {
+		unsigned long n_tracks = 0;
+		fin.read(reinterpret_cast<char*>(&n_tracks), sizeof(n_tracks));
+		for (unsigned long t = 0 ; t < n_tracks && !fin.fail() ; t ++) {
+			int ind = 0, from = 0, to = 0;
+			fin.read(reinterpret_cast<char*>(&ind), sizeof(int));
+			fin.read(reinterpret_cast<char*>(&from), sizeof(int));
+			fin.read(reinterpret_cast<char*>(&to), sizeof(int));
+			H.bannedPairs[i].push_back(IBD2track(ind, from, to));
+		}
+	}
+
+	//Genotype graphs
+	for (int i = 0 ; i < G.n_ind ; i ++) genotype_read(fin, G.vecG[i]);
+
+	//Random number generator
+	string engine;
+	string_read(fin, engine);
+	istringstream(engine) >> rng.getEngine();
+	if (fin.fail()) vrb.error("Checkpoint file [" + fname + "] is corrupted");
+
+	vrb.bullet("Checkpoint reading [it=" + stb.str(S.current_iteration) + " / " + stb.str(usize / 1048576.0, 1) + "Mb] (" + stb.str(tac.rel_time()*1.0/1000, 2) + "s)");
+}
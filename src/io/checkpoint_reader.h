@@ -0,0 +1,60 @@
+/*******************************************************************************
+ * Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+#ifndef _CHECKPOINT_READER_H
+#define _CHECKPOINT_READER_H
+
+#include <utils/otools.h>
+
+#include <io/checkpoint_writer.h>
+
+class checkpoint_reader {
+public:
+	//DATA
+	genotype_set & G;
+	haplotype_set & H;
+
+	//CONSTRUCTORS/DESCTRUCTORS
+	checkpoint_reader(genotype_set &, haplotype_set &);
+	~checkpoint_reader();
+
+	//ROUTINES
+	void string_read(istream & fin, string & x);
+	template < class T > void array_read(istream & fin, vector < T > & x);
+	void genotype_read(istream & fin, genotype * g);
+
+	//IO
+	void readCheckpoint(string, mcmc_state &);
+};
+
+template < class T >
+void checkpoint_reader::array_read(istream & fin, vector < T > & x) {
+	unsigned long n = 0;
+	fin.read(reinterpret_cast<char*>(&n), sizeof(n));
+	if (fin.fail() || n > fin.rdbuf()->in_avail() / sizeof(T)) {
+		fin.setstate(std::ios::failbit);
+		n = 0;
+	}
+	x = vector < T > (n);
+	if (n) fin.read(reinterpret_cast<char*>(x.data()), n * sizeof(T));
+}
+
+#endif
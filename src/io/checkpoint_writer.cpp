@@ -0,0 +1,167 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+#include <io/checkpoint_writer.h>
+
+#include <zlib.h>
+
+void * checkpoint_callback(void * ptr) {
+	checkpoint_writer * W = static_cast< checkpoint_writer * >( ptr );
+	W->flush();
+	pthread_exit(NULL);
+	return NULL;
+}
+
+checkpoint_writer::checkpoint_writer() {
+	writing = false;
+	failed = false;
+	n_written = 0;
+}
+
+checkpoint_writer::~checkpoint_writer() {
+	wait();
+}
+
+void checkpoint_writer::open(string _fname) {
+	fname = _fname;
+	string ftmp = fname + ".tmp";
+	ofstream fd (ftmp.c_str(), std::ios::out | std::ios::binary);
+	if (fd.fail()) vrb.error("Impossible to create checkpoint file [" + fname + "]");
+	fd.close();
+	remove(ftmp.c_str());
+}
+
+void checkpoint_writer::string_write(ostream & fout, const string & x) {
+	array_write(fout, x.data(), x.size());
+}
+
+void checkpoint_writer::genotype_write(ostream & fout, genotype * g) {
+	// integers
+	fout.write(reinterpret_cast<char*>(&g->n_segments), sizeof(g->n_segments));
+	fout.write(reinterpret_cast<char*>(&g->n_ambiguous), sizeof(g->n_ambiguous));
+	fout.write(reinterpret_cast<char*>(&g->n_missing), sizeof(g->n_missing));
+	fout.write(reinterpret_cast<char*>(&g->n_transitions), sizeof(g->n_transitions));
+	fout.write(reinterpret_cast<char*>(&g->n_stored_transitionProbs), sizeof(g->n_stored_transitionProbs));
+	fout.write(reinterpret_cast<char*>(&g->n_storage_events), sizeof(g->n_storage_events));
+	fout.write(reinterpret_cast<char*>(&g->double_precision), sizeof(g->double_precision));
+	// vectors
+	array_write(fout, g->Variants.data(), g->Variants.size());
+	array_write(fout, g->Ambiguous.data(), g->Ambiguous.size());
+	array_write(fout, g->Diplotypes.data(), g->Diplotypes.size());
+	array_write(fout, g->Lengths.data(), g->Lengths.size());
+	// accumulated phase probabilities
+	unsigned long n_mask = g->ProbMask.size();
+	fout.write(reinterpret_cast<char*>(&n_mask), sizeof(n_mask));
+	array_write(fout, g->ProbMask.bytes(), g->ProbMask.sizeBytes());
+	array_write(fout, g->ProbStored.data(), g->ProbStored.size());
+	array_write(fout, g->ProbMissing.data(), g->ProbMissing.size());
+}
+
+//Serialises the state in memory, then compresses and writes it in background while the next iteration runs
+void checkpoint_writer::write(genotype_set & G, haplotype_set & H, mcmc_state & S) {
+	tac.clock();
+	wait();
+	ostringstream fout;
+
+	//Dimensions and samples
+	unsigned long n_ind = G.n_ind, n_site = H.n_site, n_hap = H.n_hap, n_row_bytes = H.H_opt_hap.n_cols / 8;
+	fout.write(reinterpret_cast<char*>(&n_ind), sizeof(n_ind));
+	fout.write(reinterpret_cast<char*>(&n_site), sizeof(n_site));
+	fout.write(reinterpret_cast<char*>(&n_hap), sizeof(n_hap));
+	fout.write(reinterpret_cast<char*>(&n_row_bytes), sizeof(n_row_bytes));
+	for (int i = 0 ; i < G.n_ind ; i ++) string_write(fout, G.vecG[i]->name);
+
+	//MCMC cursor
+	string_write(fout, S.scheme);
+	fout.write(reinterpret_cast<char*>(&S.stage), sizeof(S.stage));
+	fout.write(reinterpret_cast<char*>(&S.iter), sizeof(S.iter));
+	fout.write(reinterpret_cast<char*>(&S.current_iteration), sizeof(S.current_iteration));
+	fout.write(reinterpret_cast<char*>(&S.n_main_iterations), sizeof(S.n_main_iterations));
+	fout.write(reinterpret_cast<char*>(&S.n_old_segments), sizeof(S.n_old_segments));
+	fout.write(reinterpret_cast<char*>(&S.n_prev_segments), sizeof(S.n_prev_segments));
+	fout.write(reinterpret_cast<char*>(&S.skip_to_main), sizeof(S.skip_to_main));
+	array_write(fout, S.iteration_done.data(), S.iteration_done.size());
+	vector < unsigned char > frozen = vector < unsigned char > (S.frozen.begin(), S.frozen.end());
+	array_write(fout, frozen.data(), frozen.size());
+	array_write(fout, S.stable_iterations.data(), S.stable_iterations.size());
+	array_write(fout, S.stable_transitions.data(), S.stable_transitions.size());
+	unsigned long n_frozen_neighbours = S.frozen_neighbours.size();
+	fout.write(reinterpret_cast<char*>(&n_frozen_neighbours), sizeof(n_frozen_neighbours));
+	for (int i = 0 ; i < S.frozen_neighbours.size() ; i ++) array_write(fout, S.frozen_neighbours[i].data(), S.frozen_neighbours[i].size());
+
+	//Haplotypes of the main samples [reference haplotypes are read again from the input files]
+	array_write(fout, H.H_opt_hap.bytes, 2UL * n_ind * n_row_bytes);
+
+	//IBD2 constraints
+	unsigned long n_banned = H.bannedPairs.size();
+	fout.write(reinterpret_cast<char*>(&n_banned), sizeof(n_banned));
+	for (int i = 0 ; i < H.bannedPairs.size() ; i ++) {
+		unsigned long n_tracks = H.bannedPairs[i].size();
+		fout.write(reinterpret_cast<char*>(&n_tracks), sizeof(n_tracks));
+		for (int t = 0 ; t < H.bannedPairs[i].size() ; t ++) {
+			fout.write(reinterpret_cast<char*>(&H.bannedPairs[i][t].ind), sizeof(int));
+			fout.write(reinterpret_cast<char*>(&H.bannedPairs[i][t].from), sizeof(int));
+			fout.write(reinterpret_cast<char*>(&H.bannedPairs[i][t].to), sizeof(int));
+		}
+	}
+
+	//Genotype graphs
+	for (int i = 0 ; i < G.n_ind ; i ++) genotype_write(fout, G.vecG[i]);
+
+	//Random number generator
+	ostringstream engine;
+	engine << rng.getEngine();
+	string_write(fout, engine.str());
+
+	buffer = fout.str();
+	writing = true;
+	pthread_create(&id_thread, NULL, checkpoint_callback, static_cast<void *>(this));
+	vrb.bullet("Checkpoint [it=" + stb.str(S.current_iteration) + " / " + stb.str(buffer.size() / 1048576.0, 1) + "Mb written in background] (" + stb.str(tac.rel_time()*1.0/1000, 2) + "s)");
+}
+
+//Runs in the background thread: the file is written aside then renamed so that a preempted write never corrupts the last checkpoint
+void checkpoint_writer::flush() {
+	unsigned long usize = buffer.size(), csize = 0;
+	uLongf zsize = compressBound(usize);
+	vector < unsigned char > zbuffer = vector < unsigned char > (zsize);
+	failed = (compress2(&zbuffer[0], &zsize, reinterpret_cast<const Bytef*>(buffer.data()), usize, Z_BEST_SPEED) != Z_OK);
+	string().swap(buffer);
+	if (failed) return;
+	csize = zsize;
+	string ftmp = fname + ".tmp";
+	unsigned int version = CHECKPOINT_VERSION;
+	ofstream fd (ftmp.c_str(), std::ios::out | std::ios::binary);
+	fd.write(CHECKPOINT_MAGIC, 8);
+	fd.write(reinterpret_cast<char*>(&version), sizeof(version));
+	fd.write(reinterpret_cast<char*>(&usize), sizeof(usize));
+	fd.write(reinterpret_cast<char*>(&csize), sizeof(csize));
+	fd.write(reinterpret_cast<char*>(&zbuffer[0]), csize);
+	fd.close();
+	failed = fd.fail() || (rename(ftmp.c_str(), fname.c_str()) != 0);
+}
+
+void checkpoint_writer::wait() {
+	if (!writing) return;
+	pthread_join(id_thread, NULL);
+	writing = false;
+	if (failed) vrb.warning("Impossible to write checkpoint file [" + fname + "]");
+	else n_written ++;
+}
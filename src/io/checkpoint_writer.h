@@ -0,0 +1,84 @@
+/*******************************************************************************
+ * Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+#ifndef _CHECKPOINT_WRITER_H
+#define _CHECKPOINT_WRITER_H
+
+#include <utils/otools.h>
+
+#include <containers/genotype_set.h>
+#include <containers/haplotype_set.h>
+
+//Checkpoint layout: [magic|version] [uncompressed size|compressed size] [zlib compressed state]
+//State: [dimensions|sample names] [MCMC cursor] [H_opt_hap rows of the main samples] [IBD2 constraints] [genotype graphs ...] [RNG]
+#define CHECKPOINT_MAGIC	"SHP4CKPT"
+#define CHECKPOINT_VERSION	1
+
+//State of phaser::phase() at an iteration boundary
+struct mcmc_state {
+	string scheme;								// Iteration scheme [must match on resume]
+	unsigned int stage, iter;					// Next iteration to run
+	unsigned long current_iteration, n_main_iterations, n_old_segments, n_prev_segments;
+	bool skip_to_main;
+	vector < unsigned int > iteration_done;
+	vector < bool > frozen;
+	vector < unsigned int > stable_iterations, stable_transitions;
+	vector < vector < int > > frozen_neighbours;
+};
+
+class checkpoint_writer {
+public:
+	//DATA
+	string fname;
+	string buffer;				// Serialised state, compressed and written by a background thread
+	pthread_t id_thread;
+	bool writing, failed;
+	unsigned long n_written;
+
+	//CONSTRUCTORS/DESCTRUCTORS
+	checkpoint_writer();
+	~checkpoint_writer();
+
+	//ROUTINES
+	bool active();
+	void string_write(ostream & fout, const string & x);
+	template < class T > void array_write(ostream & fout, const T * x, unsigned long n);
+	void genotype_write(ostream & fout, genotype * g);
+	void write(genotype_set &, haplotype_set &, mcmc_state &);
+	void flush();
+	void wait();
+
+	//IO
+	void open(string);
+};
+
+inline
+bool checkpoint_writer::active() {
+	return !fname.empty();
+}
+
+template < class T >
+void checkpoint_writer::array_write(ostream & fout, const T * x, unsigned long n) {
+	fout.write(reinterpret_cast<const char*>(&n), sizeof(n));
+	if (n) fout.write(reinterpret_cast<const char*>(x), n * sizeof(T));
+}
+
+#endif
@@ -45,14 +45,7 @@ genotype_reader::~genotype_reader() {
 void genotype_reader::allocateGenotypes() {
 	assert(n_variants != 0 && (n_main_samples+n_ref_samples) != 0);
 	//Genotypes
-	G.vecG = vector < genotype * > (n_main_samples);
-	for (unsigned int i = 0 ; i < n_main_samples ; i ++) {
-		G.vecG[i] = new genotype (i);
-		G.vecG[i]->n_variants = n_variants;
-		G.vecG[i]->Variants = vector < unsigned char > (DIV2(n_variants) + MOD2(n_variants), 0);
-	}
-	G.n_ind = n_main_samples;
-	G.n_site = n_variants;
+	G.allocate(n_main_samples, n_variants);
 	//Haplotypes
 	H.n_ind = n_main_samples;
 	H.n_hap = 2 * (n_main_samples + n_ref_samples);
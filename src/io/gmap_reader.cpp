@@ -22,6 +22,8 @@
 
 #include <io/gmap_reader.h>
 
+#include <sys/stat.h>
+
 gmap_reader::gmap_reader() {
 }
 
@@ -30,29 +32,203 @@ gmap_reader::~gmap_reader() {
 	vector < double > ().swap(pos_cm);
 }
 
-void gmap_reader::readGeneticMapFile(string fmap) {
+#define GMAP_CACHE_MAGIC	"SHP4GMP2"
+#define GMAP_BUFFER_SIZE	(1<<20)
+
+static inline bool is_blank(char c) {
+	return (c == ' ' || c == '\t' || c == '\r');
+}
+
+static inline const char * skip_blank(const char * p, const char * e) {
+	while (p < e && is_blank(*p)) p++;
+	return p;
+}
+
+static inline bool scan_int(const char * p, const char * e, int & v) {
+	bool neg = (p < e && *p == '-');
+	if (neg || (p < e && *p == '+')) p++;
+	if (p == e) return false;
+	long val = 0;
+	for (; p < e ; p++) {
+		if (*p < '0' || *p > '9') return false;
+		val = val * 10 + (*p - '0');
+	}
+	v = (int)(neg?-val:val);
+	return true;
+}
+
+static inline bool scan_double(const char * p, const char * e, double & v) {
+	//Fast path: at most 15 digits and a small exponent, exactly rounded as a single division/multiplication
+	static const double pow10 [] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+	const char * b = p;
+	bool neg = (p < e && *p == '-');
+	if (neg || (p < e && *p == '+')) p++;
+	unsigned long mant = 0;
+	int n_digits = 0, exp10 = 0;
+	for (; p < e && *p >= '0' && *p <= '9' ; p++, n_digits++) mant = mant * 10 + (*p - '0');
+	if (p < e && *p == '.') for (p++ ; p < e && *p >= '0' && *p <= '9' ; p++, n_digits++, exp10--) mant = mant * 10 + (*p - '0');
+	if (p < e && (*p == 'e' || *p == 'E')) {
+		int ev = 0;
+		if (!scan_int(p + 1, e, ev)) return false;
+		exp10 += ev;
+		p = e;
+	}
+	if (p != e || !n_digits) return false;
+	if (n_digits <= 15 && exp10 >= -22 && exp10 <= 22) {
+		v = (exp10 < 0)?(mant / pow10[-exp10]):(mant * pow10[exp10]);
+		if (neg) v = -v;
+		return true;
+	}
+	//Slow path for unusual notations
+	char tmp [64];
+	if (e - b >= 64) return false;
+	memcpy(tmp, b, e - b);
+	tmp[e - b] = '\0';
+	v = strtod(tmp, NULL);
+	return true;
+}
+
+void gmap_reader::restrictRange(int bp_from, int bp_to) {
+	//Keep first/last points [mean rate], the flanking points and all points in between [interpolation]
+	if (pos_bp.size() < 3) return;
+	int i_from = upper_bound(pos_bp.begin(), pos_bp.end(), bp_from) - pos_bp.begin() - 1;
+	int i_to = upper_bound(pos_bp.begin(), pos_bp.end(), bp_to) - pos_bp.begin();
+	i_from = max(i_from, 0);
+	i_to = min(i_to, (int)pos_bp.size() - 1);
+	vector < int > sub_bp;
+	vector < double > sub_cm;
+	if (i_from > 0) { sub_bp.push_back(pos_bp[0]); sub_cm.push_back(pos_cm[0]); }
+	sub_bp.insert(sub_bp.end(), pos_bp.begin() + i_from, pos_bp.begin() + i_to + 1);
+	sub_cm.insert(sub_cm.end(), pos_cm.begin() + i_from, pos_cm.begin() + i_to + 1);
+	if (i_to < pos_bp.size() - 1) { sub_bp.push_back(pos_bp.back()); sub_cm.push_back(pos_cm.back()); }
+	pos_bp.swap(sub_bp);
+	pos_cm.swap(sub_cm);
+}
+
+//Cache layout: [magic|map size|map mtime|n points] [bp x n] [cM x n]; a cache made from another map or an older version of it is ignored
+bool gmap_reader::readCache(string fcache, string fmap) {
+	struct stat st_map, st_cache;
+	if (stat(fcache.c_str(), &st_cache) || stat(fmap.c_str(), &st_map)) return false;
+	ifstream fd (fcache.c_str(), std::ios::in | std::ios::binary);
+	char magic [8];
+	long map_size, map_mtime;
+	unsigned long n_points;
+	fd.read(magic, 8);
+	fd.read(reinterpret_cast<char*>(&map_size), sizeof(map_size));
+	fd.read(reinterpret_cast<char*>(&map_mtime), sizeof(map_mtime));
+	fd.read(reinterpret_cast<char*>(&n_points), sizeof(n_points));
+	if (fd.fail() || memcmp(magic, GMAP_CACHE_MAGIC, 8) || map_size != (long)st_map.st_size || map_mtime != (long)st_map.st_mtime) return false;
+	if (n_points * (sizeof(int) + sizeof(double)) > (unsigned long)st_cache.st_size) return false;
+	pos_bp = vector < int > (n_points);
+	pos_cm = vector < double > (n_points);
+	fd.read(reinterpret_cast<char*>(&pos_bp[0]), n_points * sizeof(int));
+	fd.read(reinterpret_cast<char*>(&pos_cm[0]), n_points * sizeof(double));
+	if (fd.fail()) {
+		vector < int > ().swap(pos_bp);
+		vector < double > ().swap(pos_cm);
+		return false;
+	}
+	return true;
+}
+
+//Failing to write the cache [read-only directory, full disk] is not fatal: the map is simply parsed again next time
+void gmap_reader::writeCache(string fcache, string fmap) {
+	struct stat st_map;
+	if (stat(fmap.c_str(), &st_map)) return;
+	ofstream fd (fcache.c_str(), std::ios::out | std::ios::binary);
+	if (fd.fail()) { vrb.warning("Cannot write genetic map cache [" + fcache + "], use --map-cache-file to store it elsewhere"); return; }
+	long map_size = st_map.st_size, map_mtime = st_map.st_mtime;
+	unsigned long n_points = pos_bp.size();
+	fd.write(GMAP_CACHE_MAGIC, 8);
+	fd.write(reinterpret_cast<char*>(&map_size), sizeof(map_size));
+	fd.write(reinterpret_cast<char*>(&map_mtime), sizeof(map_mtime));
+	fd.write(reinterpret_cast<char*>(&n_points), sizeof(n_points));
+	fd.write(reinterpret_cast<char*>(pos_bp.data()), n_points * sizeof(int));
+	fd.write(reinterpret_cast<char*>(pos_cm.data()), n_points * sizeof(double));
+	fd.close();
+	if (fd.fail()) {
+		vrb.warning("Cannot write genetic map cache [" + fcache + "], use --map-cache-file to store it elsewhere");
+		remove(fcache.c_str());
+	}
+}
+
+void gmap_reader::readGeneticMapFile(string fmap, int bp_from, int bp_to, string fcache) {
 	tac.clock();
-	string buffer;
-	vector < string > tokens;
-	int line = 0;
+	bool cache = !fcache.empty();
+
+	//Cached map
+	if (cache && readCache(fcache, fmap)) {
+		int n_points = pos_bp.size();
+		restrictRange(bp_from, bp_to);
+		vrb.bullet("GMAP cache [n=" + stb.str(n_points) + " / kept=" + stb.str(pos_bp.size()) + "] (" + stb.str(tac.rel_time()*1.0/1000, 2) + "s)");
+		return;
+	}
+
+	//Parse the map by large blocks, line by line, without any allocation
 	input_file fd_gmap(fmap);
 	if (fd_gmap.fail()) vrb.error("Cannot open genetic map file");
-	getline(fd_gmap, buffer, '\n');
-	int prev_bp = 0;
-	double prev_cm = 0;
-	while (getline(fd_gmap, buffer, '\n')) {
-		if (stb.split(buffer, tokens) == 3) {
-			int curr_bp = atoi(tokens[0].c_str());
-			double curr_cm = atof(tokens[2].c_str());
+	vector < char > buffer = vector < char > (GMAP_BUFFER_SIZE);
+	int line = 0, prev_bp = 0, last_bp = -1;
+	double prev_cm = 0, last_cm = 0;
+	bool header = true, done = false, right_flank = false, stopped = false;
+	size_t n_left = 0;
+	while (!done) {
+		fd_gmap.read(&buffer[n_left], buffer.size() - n_left);
+		size_t n_read = n_left + fd_gmap.gcount();
+		if (n_read == n_left) {
+			if (!n_left) break;
+			buffer[n_read++] = '\n';
+			done = true;
+		}
+		char * p = &buffer[0], * e = p + n_read;
+		for (char * eol ; (eol = (char*)memchr(p, '\n', e - p)) != NULL ; p = eol + 1) {
+			if (header) { header = false; continue; }
+
+			//Tokenize
+			const char * tok_b [4], * tok_e [4];
+			int n_tok = 0;
+			for (const char * q = skip_blank(p, eol) ; q < eol && n_tok < 4 ; q = skip_blank(q, eol)) {
+				tok_b[n_tok] = q;
+				while (q < eol && !is_blank(*q)) q++;
+				tok_e[n_tok++] = q;
+			}
+			int curr_bp;
+			double curr_cm;
+			if (n_tok != 3) vrb.error("Parsing line " + stb.str(line) + " : incorrect number of columns, observed: " + stb.str(n_tok) + " expected: 3");
+			if (!scan_int(tok_b[0], tok_e[0], curr_bp) || !scan_double(tok_b[2], tok_e[2], curr_cm)) vrb.error("Parsing line " + stb.str(line) + " : cannot read position");
 			if (curr_bp < prev_bp || curr_cm < prev_cm)
 				vrb.error("Wrong order in your genetic map file " + stb.str(prev_bp) + "bp / " + stb.str(prev_cm,5) + "cM > " + stb.str(curr_bp) + "bp / " + stb.str(curr_cm,5) + "cM");
-			pos_bp.push_back(curr_bp);
-			pos_cm.push_back(curr_cm);
+			line++;
+
+			//Keep first point, left flank, points in range, right flank [and last point, see below]
+			if (cache || line == 1 || (curr_bp > bp_from && curr_bp <= bp_to) || (curr_bp > bp_to && !right_flank)) {
+				pos_bp.push_back(curr_bp);
+				pos_cm.push_back(curr_cm);
+				right_flank = right_flank || (curr_bp > bp_to);
+			} else if (curr_bp <= bp_from) {
+				if (pos_bp.size() < 2) { pos_bp.push_back(curr_bp); pos_cm.push_back(curr_cm); }
+				else { pos_bp.back() = curr_bp; pos_cm.back() = curr_cm; }
+			}
+			last_bp = curr_bp;
+			last_cm = curr_cm;
 			prev_bp = curr_bp;
 			prev_cm = curr_cm;
-		} else vrb.error("Parsing line " + stb.str(line) + " : incorrect number of columns, observed: " + stb.str(tokens.size()) + " expected: 3");
-		line++;
+
+			//Both flanks found: the rest of the file cannot change interpolation
+			if (!cache && right_flank && pos_bp[0] <= bp_from) { stopped = true; done = true; break; }
+		}
+		n_left = e - p;
+		if (n_left == buffer.size()) vrb.error("Parsing line " + stb.str(line) + " : line too long");
+		if (!done) memmove(&buffer[0], p, n_left);
 	}
 	fd_gmap.close();
-	vrb.bullet("GMAP parsing [n=" + stb.str(line) + "] (" + stb.str(tac.rel_time()*1.0/1000, 2) + "s)");
+	if (!stopped && line && pos_bp.back() != last_bp) {
+		pos_bp.push_back(last_bp);
+		pos_cm.push_back(last_cm);
+	}
+	if (cache) {
+		writeCache(fcache, fmap);
+		restrictRange(bp_from, bp_to);
+	}
+	vrb.bullet("GMAP parsing [n=" + stb.str(line) + " / kept=" + stb.str(pos_bp.size()) + "] (" + stb.str(tac.rel_time()*1.0/1000, 2) + "s)");
 }
@@ -34,8 +34,13 @@ public:
 	gmap_reader();
 	~gmap_reader();
 
+	//ROUTINES
+	void restrictRange(int, int);
+	bool readCache(string, string);
+	void writeCache(string, string);
+
 	//IO
-	void readGeneticMapFile(string);
+	void readGeneticMapFile(string, int bp_from = 0, int bp_to = numeric_limits < int >::max(), string fcache = "");
 };
 
 #endif
@@ -21,68 +21,146 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include <io/graph_writer.h>
 
-graph_writer::graph_writer(genotype_set & _G, variant_map & _V): G(_G), V(_V) {
+#include <zlib.h>
+
+graph_writer::graph_writer(genotype_set & _G, variant_map & _V, bool _compressed): G(_G), V(_V) {
+	compressed = _compressed;
 }
 
 graph_writer::~graph_writer() {
 }
 
-void graph_writer::binary_write(output_file & fout, const vector<bool> & x) {
-	vector<bool>::size_type n = x.size();
-	fout.write((const char*)&n, sizeof(std::vector<bool>::size_type));
-	for(std::vector<bool>::size_type i = 0; i < n;) {
-		unsigned char aggr = 0;
-		for(unsigned char mask = 1; mask > 0 && i < n; ++i, mask <<= 1) if(x.at(i)) aggr |= mask;
-		fout.write((const char*)&aggr, sizeof(unsigned char));
-    }
+void graph_writer::binary_write(ostream & fout, const bit_vector & x) {
+	size_t n = x.size();
+	fout.write((const char*)&n, sizeof(size_t));
+	fout.write((const char*)x.bytes(), x.sizeBytes());
 }
 
-void graph_writer::string_write(output_file & fout, string & x) {
+void graph_writer::string_write(ostream & fout, string & x) {
 	size_t size_str = x.size();
 	fout.write(reinterpret_cast<char*>(&size_str), sizeof(size_str));
 	fout.write(reinterpret_cast<char*>(&x[0]), size_str);
 }
 
-void graph_writer::writeGraphs(string fname) {
-	// Init
-	tac.clock();
-	output_file fd (fname);
+void graph_writer::align_write(ostream & fout) {
+	unsigned long pos = fout.tellp();
+	for (unsigned long p = pos ; p < BINGRAPH_ALIGN(pos) ; p ++) fout.put(0);
+}
 
-	//Write variant map
+void graph_writer::block_write(ofstream & fout, string & x, unsigned long & offset, unsigned long & csize) {
+	unsigned long usize = x.size();
+	if (!compressed) {
+		csize = 0;
+		fout.write(reinterpret_cast<char*>(&usize), sizeof(usize));
+		fout.write(reinterpret_cast<char*>(&csize), sizeof(csize));
+		fout.write(x.data(), usize);
+		offset += 2 * sizeof(unsigned long) + usize;
+		for (; offset < BINGRAPH_ALIGN(offset) ; offset ++) fout.put(0);
+		return;
+	}
+	uLongf zsize = compressBound(usize);
+	vector < unsigned char > zbuffer = vector < unsigned char > (zsize);
+	if (compress2(&zbuffer[0], &zsize, reinterpret_cast<const Bytef*>(x.data()), usize, Z_DEFAULT_COMPRESSION) != Z_OK) vrb.error("Failed to compress BIN block");
+	csize = zsize;
+	fout.write(reinterpret_cast<char*>(&usize), sizeof(usize));
+	fout.write(reinterpret_cast<char*>(&csize), sizeof(csize));
+	fout.write(reinterpret_cast<char*>(&zbuffer[0]), csize);
+	offset += 2 * sizeof(unsigned long) + csize;
+}
+
+void graph_writer::variant_write(ostream & fout) {
 	int n_variants = V.vec_pos.size();
-	fd.write(reinterpret_cast<char*>(&n_variants), sizeof(n_variants));
+	fout.write(reinterpret_cast<char*>(&n_variants), sizeof(n_variants));
 	for (int l = 0 ; l < n_variants ; l ++) {
-		string_write(fd, V.vec_pos[l]->chr);
-		fd.write(reinterpret_cast<char*>(&V.vec_pos[l]->bp), sizeof(V.vec_pos[l]->bp));
-		string_write(fd, V.vec_pos[l]->id);
-		string_write(fd, V.vec_pos[l]->ref);
-		string_write(fd, V.vec_pos[l]->alt);
-		fd.write(reinterpret_cast<char*>(&V.vec_pos[l]->idx), sizeof(V.vec_pos[l]->idx));
+		string_write(fout, V.vec_pos[l]->chr);
+		fout.write(reinterpret_cast<char*>(&V.vec_pos[l]->bp), sizeof(V.vec_pos[l]->bp));
+		string_write(fout, V.vec_pos[l]->id);
+		string_write(fout, V.vec_pos[l]->ref);
+		string_write(fout, V.vec_pos[l]->alt);
+		fout.write(reinterpret_cast<char*>(&V.vec_pos[l]->idx), sizeof(V.vec_pos[l]->idx));
+	}
+}
+
+void graph_writer::genotype_write(ostream & fout, genotype * g) {
+	// name
+	string_write(fout, g->name);
+	// integers
+	fout.write(reinterpret_cast<char*>(&g->index), sizeof(g->index));
+	fout.write(reinterpret_cast<char*>(&g->n_segments), sizeof(g->n_segments));
+	fout.write(reinterpret_cast<char*>(&g->n_variants), sizeof(g->n_variants));
+	fout.write(reinterpret_cast<char*>(&g->n_ambiguous), sizeof(g->n_ambiguous));
+	fout.write(reinterpret_cast<char*>(&g->n_missing), sizeof(g->n_missing));
+	fout.write(reinterpret_cast<char*>(&g->n_transitions), sizeof(g->n_transitions));
+	fout.write(reinterpret_cast<char*>(&g->n_stored_transitionProbs), sizeof(g->n_stored_transitionProbs));
+	fout.write(reinterpret_cast<char*>(&g->n_storage_events), sizeof(g->n_storage_events));
+	// vectors [8 bytes aligned when uncompressed so that they can be viewed in place once mapped]
+	if (!compressed) align_write(fout);
+	fout.write(reinterpret_cast<char*>(g->Variants.data()), g->Variants.size());
+	if (!compressed) align_write(fout);
+	fout.write(reinterpret_cast<char*>(g->Ambiguous.data()), g->Ambiguous.size());
+	if (!compressed) align_write(fout);
+	fout.write(reinterpret_cast<char*>(g->Diplotypes.data()), g->Diplotypes.size() * sizeof(unsigned long));
+	if (!compressed) align_write(fout);
+	fout.write(reinterpret_cast<char*>(g->Lengths.data()), g->Lengths.size() * sizeof(unsigned short));
+	if (!compressed) align_write(fout);
+	binary_write(fout, g->ProbMask);
+	if (!compressed) align_write(fout);
+	if (g->prob_bits == 32) {
+		fout.write(reinterpret_cast<char*>(g->ProbStored.data()), g->ProbStored.size() * sizeof(float));
+		if (!compressed) align_write(fout);
+		fout.write(reinterpret_cast<char*>(g->ProbMissing.data()), g->ProbMissing.size() * sizeof(float));
+	} else {
+		unsigned long n_bytes_stored = g->n_stored_transitionProbs * (g->prob_bits / 8);
+		fout.write(reinterpret_cast<char*>(g->ProbQuantized.data()), n_bytes_stored);
+		if (!compressed) align_write(fout);
+		fout.write(reinterpret_cast<char*>(g->ProbQuantized.data() + n_bytes_stored), g->ProbQuantized.size() - n_bytes_stored);
 	}
+}
+
+void graph_writer::writeGraphs(string fname) {
+	// Init
+	tac.clock();
+	ofstream fd (fname.c_str(), std::ios::out | std::ios::binary);
+	if (fd.fail()) vrb.error("Impossible to create BIN file [" + fname + "]");
+	unsigned int version = BINGRAPH_VERSION, prob_bits = G.prob_bits;
+	unsigned long offset = 0, csize = 0, total_usize = 0, total_csize = 0;
+	fd.write(BINGRAPH_MAGIC, 8);
+	fd.write(reinterpret_cast<char*>(&version), sizeof(version));
+	fd.write(reinterpret_cast<char*>(&prob_bits), sizeof(prob_bits));
+	offset = 8 + sizeof(version) + sizeof(prob_bits);
+
+	//Write variant map as header block
+	ostringstream hdr;
+	variant_write(hdr);
+	string buffer = hdr.str();
+	block_write(fd, buffer, offset, csize);
 
-	//Write genotype graphs
-	fd.write(reinterpret_cast<char*>(&G.n_ind), sizeof(G.n_ind));
+	//Write one independently compressed block per genotype graph
+	vector < unsigned long > offsets = vector < unsigned long > (G.n_ind, 0);
 	for (int g  = 0 ; g < G.n_ind ; g++) {
-		// name
-		string_write(fd, G.vecG[g]->name);
-		// integers
-		fd.write(reinterpret_cast<char*>(&G.vecG[g]->index), sizeof(G.vecG[g]->index));
-		fd.write(reinterpret_cast<char*>(&G.vecG[g]->n_segments), sizeof(G.vecG[g]->n_segments));
-		fd.write(reinterpret_cast<char*>(&G.vecG[g]->n_variants), sizeof(G.vecG[g]->n_variants));
-		fd.write(reinterpret_cast<char*>(&G.vecG[g]->n_ambiguous), sizeof(G.vecG[g]->n_ambiguous));
-		fd.write(reinterpret_cast<char*>(&G.vecG[g]->n_missing), sizeof(G.vecG[g]->n_missing));
-		fd.write(reinterpret_cast<char*>(&G.vecG[g]->n_transitions), sizeof(G.vecG[g]->n_transitions));
-		fd.write(reinterpret_cast<char*>(&G.vecG[g]->n_stored_transitionProbs), sizeof(G.vecG[g]->n_stored_transitionProbs));
-		fd.write(reinterpret_cast<char*>(&G.vecG[g]->n_storage_events), sizeof(G.vecG[g]->n_storage_events));
+		ostringstream rec;
+		genotype_write(rec, G.vecG[g]);
+		buffer = rec.str();
+		offsets[g] = offset;
+		block_write(fd, buffer, offset, csize);
+		total_usize += buffer.size();
+		total_csize += csize?csize:buffer.size();
+	}
 
-		// vectors
-		fd.write(reinterpret_cast<char*>(&G.vecG[g]->Variants[0]), G.vecG[g]->Variants.size());
-		fd.write(reinterpret_cast<char*>(&G.vecG[g]->Ambiguous[0]), G.vecG[g]->Ambiguous.size());
-		fd.write(reinterpret_cast<char*>(&G.vecG[g]->Diplotypes[0]), G.vecG[g]->Diplotypes.size() * sizeof(unsigned long));
-		fd.write(reinterpret_cast<char*>(&G.vecG[g]->Lengths[0]), G.vecG[g]->Lengths.size() * sizeof(unsigned short));
-		binary_write(fd, G.vecG[g]->ProbMask);
-		fd.write(reinterpret_cast<char*>(&G.vecG[g]->ProbStored[0]), G.vecG[g]->ProbStored.size() * sizeof(float));
-		fd.write(reinterpret_cast<char*>(&G.vecG[g]->ProbMissing[0]), G.vecG[g]->ProbMissing.size() * sizeof(float));
+	//Write trailing index [sample name -> block offset]
+	unsigned long index_offset = offset;
+	ostringstream idx;
+	idx.write(reinterpret_cast<char*>(&G.n_ind), sizeof(G.n_ind));
+	for (int g  = 0 ; g < G.n_ind ; g++) {
+		string_write(idx, G.vecG[g]->name);
+		idx.write(reinterpret_cast<char*>(&offsets[g]), sizeof(offsets[g]));
 	}
-	vrb.bullet("BIN writing [Compressed / N=" + stb.str(G.n_ind) + " / L=" + stb.str(V.size()) + "] (" + stb.str(tac.rel_time()*0.001, 2) + "s)");
+	buffer = idx.str();
+	block_write(fd, buffer, offset, csize);
+	fd.write(reinterpret_cast<char*>(&index_offset), sizeof(index_offset));
+	fd.write(BINGRAPH_MAGIC, 8);
+	fd.close();
+
+	double ratio = total_csize?(total_usize * 1.0 / total_csize):0.0;
+	vrb.bullet("BIN writing [" + string(compressed?"Indexed":"Aligned") + " / N=" + stb.str(G.n_ind) + " / L=" + stb.str(V.size()) + " / bits=" + stb.str(prob_bits) + " / ratio=" + stb.str(ratio, 2) + "] (" + stb.str(tac.rel_time()*0.001, 2) + "s)");
 }
@@ -27,19 +27,32 @@
 #include <containers/variant_map.h>
 #include <containers/genotype_set.h>
 
+//Indexed BIN layout: [magic|version|prob bits] [variant map block] [sample blocks ...] [index block] [index offset|magic]
+//Each block is zlib compressed independently so that readers can seek to any sample.
+//Uncompressed files store blocks as is [csize=0] with 8 bytes aligned arrays to be memory mapped.
+//Phase probabilities are stored as floats [prob bits=32] or quantized on 16 or 8 bits (see genotype_header.h).
+#define BINGRAPH_MAGIC		"SHP4GRPH"
+#define BINGRAPH_VERSION	3
+#define BINGRAPH_ALIGN(x)	(((x)+7UL)&~7UL)
+
 class graph_writer {
 public:
 	//DATA
 	genotype_set & G;
 	variant_map & V;
+	bool compressed;
 
 	//CONSTRUCTORS/DESCTRUCTORS
-	graph_writer(genotype_set &, variant_map &);
+	graph_writer(genotype_set &, variant_map &, bool);
 	~graph_writer();
 
 	//ROUTINES
-	void binary_write(output_file & fout, const vector<bool> & x);
-	void string_write(output_file & fout, string & x);
+	void binary_write(ostream & fout, const bit_vector & x);
+	void string_write(ostream & fout, string & x);
+	void align_write(ostream & fout);
+	void block_write(ofstream & fout, string & x, unsigned long & offset, unsigned long & csize);
+	void variant_write(ostream & fout);
+	void genotype_write(ostream & fout, genotype * g);
 
 	//IO
 	void writeGraphs(string foutput);
@@ -0,0 +1,75 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+#include <io/trace_writer.h>
+
+trace_writer::trace_writer() {
+	fd = NULL;
+	chrome = false;
+	n_events = 0;
+	iteration = 0;
+	pthread_mutex_init(&mutex_write, NULL);
+}
+
+trace_writer::~trace_writer() {
+	close();
+	pthread_mutex_destroy(&mutex_write);
+}
+
+void trace_writer::open(string foutput) {
+	fd = new output_file(foutput);
+	if (fd->fail()) vrb.error("Impossible to create HMM trace file [" + foutput + "]");
+	chrome = (foutput.find(".json") != string::npos);
+	n_events = 0;
+	if (chrome) *fd << "{\"traceEvents\":[";
+	else *fd << "iteration\ttype\tworker\tsample\tn_windows\tK\tn_transitions\tn_missing\tprecision\tstart_ns\telapsed_ns" << endl;
+}
+
+void trace_writer::close() {
+	if (!fd) return;
+	if (chrome) *fd << endl << "]}" << endl;
+	fd->close();
+	delete fd;
+	fd = NULL;
+}
+
+void trace_writer::setIteration(int _iteration, string _type) {
+	iteration = _iteration;
+	iteration_type = _type;
+}
+
+void trace_writer::write(genotype_set & G, vector < trace_event > & events, int id_worker) {
+	pthread_mutex_lock(&mutex_write);
+	for (int e = 0 ; e < events.size() ; e ++, n_events ++) {
+		const trace_event & t = events[e];
+		string precision = t.double_precision?"double":"single";
+		if (chrome) {
+			*fd << (n_events?",":"") << endl;
+			*fd << "{\"name\":\"" << stb.json(G.vecG[t.ind]->name) << "\",\"cat\":\"" << stb.json(iteration_type) << "\",\"ph\":\"X\",\"pid\":" << iteration + 1 << ",\"tid\":" << id_worker;
+			*fd << ",\"ts\":" << stb.str(t.start_ns / 1e3, 3) << ",\"dur\":" << stb.str(t.elapsed_ns / 1e3, 3);
+			*fd << ",\"args\":{\"windows\":" << t.n_windows << ",\"K\":" << t.n_cond << ",\"transitions\":" << t.n_transitions << ",\"missing\":" << t.n_missing << ",\"precision\":\"" << precision << "\"}}";
+		} else {
+			*fd << iteration + 1 << "\t" << iteration_type << "\t" << id_worker << "\t" << stb.tsv(G.vecG[t.ind]->name) << "\t" << t.n_windows << "\t" << t.n_cond << "\t" << t.n_transitions << "\t" << t.n_missing << "\t" << precision << "\t" << t.start_ns << "\t" << t.elapsed_ns << endl;
+		}
+	}
+	events.clear();
+	pthread_mutex_unlock(&mutex_write);
+}
@@ -0,0 +1,61 @@
+/*******************************************************************************
+ * Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+#ifndef _TRACE_WRITER_H
+#define _TRACE_WRITER_H
+
+#include <utils/otools.h>
+
+#include <containers/genotype_set.h>
+#include <objects/compute_job.h>
+
+//Per-sample HMM cost trace [--hmm-trace]: TSV, or Chrome trace-event JSON when the file name contains ".json"
+//write() may be called concurrently by worker threads flushing their buffers
+class trace_writer {
+public:
+	//DATA
+	output_file * fd;
+	bool chrome;
+	unsigned long n_events;
+	int iteration;
+	string iteration_type;
+	pthread_mutex_t mutex_write;	// Serialises flushes from worker threads [independent of the job queue lock]
+
+	//CONSTRUCTORS/DESCTRUCTORS
+	trace_writer();
+	~trace_writer();
+
+	//ROUTINES
+	bool active();
+	void setIteration(int, string);
+	void write(genotype_set &, vector < trace_event > &, int);
+
+	//IO
+	void open(string);
+	void close();
+};
+
+inline
+bool trace_writer::active() {
+	return fd != NULL;
+}
+
+#endif
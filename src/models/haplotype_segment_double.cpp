@@ -22,7 +22,7 @@
 #include <models/haplotype_segment_double.h>
 
 
-haplotype_segment_double::haplotype_segment_double(genotype * _G, bitmatrix & H, vector < unsigned int > & idxH, coordinates & C, hmm_parameters & _M) : G(_G), M(_M){
+haplotype_segment_double::haplotype_segment_double(genotype * _G, bitmatrix & H, vector < unsigned int > & idxH, coordinates & C, hmm_parameters & _M, bitmatrix & _Hvar, workspace_arena & _Work) : G(_G), M(_M), Hvar(_Hvar), Work(_Work) {
 	segment_first = C.start_segment;
 	segment_last = C.stop_segment;
 	locus_first = C.start_locus;
@@ -37,22 +37,37 @@ haplotype_segment_double::haplotype_segment_double(genotype * _G, bitmatrix & H,
 	n_missing = missing_last - missing_first + 1;
 
 	probSumT = 0.0f;
-	prob = vector < double > (HAP_NUMBER * n_cond_haps, 0.0f);
-	probSumH = vector < double > (HAP_NUMBER, 0.0f);
-	probSumK = vector < double > (n_cond_haps, 0.0f);
-	Alpha = vector < vector < double > > (segment_last - segment_first + 1, vector < double > (HAP_NUMBER * n_cond_haps, 0.0f));
-	AlphaSum = vector < vector < double > > (segment_last - segment_first + 1, vector < double > (HAP_NUMBER, 0.0f));
-	AlphaLocus = vector < int > (segment_last - segment_first + 1, 0);
-	AlphaSumSum = vector < double > (segment_last - segment_first + 1, 0.0);
-	if (n_missing > 0) {
-		AlphaMissing = vector < vector < double > > (n_missing, vector < double > (HAP_NUMBER * n_cond_haps, 0.0f));
-		AlphaSumMissing = vector < vector < double > > (n_missing, vector < double > (HAP_NUMBER, 0.0f));
-	}
+	unsigned int n_segments = segment_last - segment_first + 1;
+	Work.reset(workspace_arena::footprint < double > (HAP_NUMBER * n_cond_haps) * (n_segments + n_missing + 1) + workspace_arena::footprint < double > (HAP_NUMBER) * (n_segments + n_missing + 1) + workspace_arena::footprint < double > (n_cond_haps) + workspace_arena::footprint < double > (n_segments) + workspace_arena::footprint < int > (n_segments) + workspace_arena::footprint < int > (locus_last - locus_first + 1));
+	prob = Work.take < double > (HAP_NUMBER * n_cond_haps);
+	probSumH = Work.take < double > (HAP_NUMBER);
+	probSumK = Work.take < double > (n_cond_haps);
+	Alpha = Work.take < double > (n_segments * HAP_NUMBER * n_cond_haps);
+	AlphaSum = Work.take < double > (n_segments * HAP_NUMBER);
+	AlphaLocus = Work.take < int > (n_segments);
+	AlphaSumSum = Work.take < double > (n_segments);
+	AlphaMissing = Work.take < double > (n_missing * HAP_NUMBER * n_cond_haps);
+	AlphaSumMissing = Work.take < double > (n_missing * HAP_NUMBER);
+	Events = Work.take < int > (locus_last - locus_first + 1);
+	fill(prob, prob + HAP_NUMBER * n_cond_haps, 0.0f);
+	fill(probSumH, probSumH + HAP_NUMBER, 0.0f);
+	fill(probSumK, probSumK + n_cond_haps, 0.0f);
 
 	//Cache efficient data transfer for conditioning haplotypes
-	curr_rel_locus_offset = Hhap.subset(H, idxH, locus_first, locus_last);
-	Hvar.allocateFast(Hhap.n_cols, Hhap.n_rows);
-	Hhap.transpose(Hvar);
+	curr_rel_locus_offset = Hvar.gather(H, idxH, locus_first, locus_last);
+	buildEvents();
+}
+
+void haplotype_segment_double::buildEvents() {
+	n_events = 0;
+	for (int s = segment_first, l = locus_first ; s <= segment_last ; l += G->Lengths[s], s ++) {
+		int l_last = l + G->Lengths[s] - 1;
+		for (int v = l ; v <= l_last ; v ++) {
+			char rare_allele = M.rare_allele[v];
+			unsigned char g = G->Variants[DIV2(v)];
+			if (v == l || v == l_last || rare_allele < 0 || !VAR_GET_HOM(MOD2(v), g) || VAR_GET_HAP0(MOD2(v), g) == rare_allele) Events[n_events++] = v;
+		}
+	}
 }
 
 haplotype_segment_double::~haplotype_segment_double() {
@@ -72,22 +87,23 @@ haplotype_segment_double::~haplotype_segment_double() {
 	curr_abs_ambiguous = 0;
 	curr_abs_transition = 0;
 	probSumT = 0.0;
-	prob.clear();
-	probSumK.clear();
-	probSumH.clear();
-	Alpha.clear();
-	AlphaSum.clear();
-	AlphaSumSum.clear();
+	prob = probSumK = probSumH = NULL;
+	Alpha = AlphaSum = AlphaSumSum = AlphaMissing = AlphaSumMissing = NULL;
+	AlphaLocus = Events = NULL;
+	n_events = 0;
 }
 
 void haplotype_segment_double::forward() {
 	curr_segment_index = segment_first;
-	curr_segment_locus = 0;
+	curr_segment_start = locus_first;
 	curr_abs_ambiguous = ambiguous_first;
 	curr_abs_missing = missing_first;
 	prev_abs_locus = locus_first;
 
-	for (curr_abs_locus = locus_first ; curr_abs_locus <= locus_last ; curr_abs_locus++) {
+	for (int e = 0 ; e < n_events ; e ++) {
+		curr_abs_locus = Events[e];
+		while (curr_abs_locus >= curr_segment_start + G->Lengths[curr_segment_index]) curr_segment_start += G->Lengths[curr_segment_index++];
+		curr_segment_locus = curr_abs_locus - curr_segment_start;
 		curr_rel_locus = curr_abs_locus - locus_first;
 		curr_rel_missing = curr_abs_missing - missing_first;
 		bool update_prev_locus = true;
@@ -115,36 +131,33 @@ void haplotype_segment_double::forward() {
 
 		if (curr_segment_locus == (G->Lengths[curr_segment_index] - 1)) SUMK();
 		if (curr_segment_locus == G->Lengths[curr_segment_index] - 1) {
-			Alpha[curr_segment_index - segment_first] = prob;
-			AlphaSum[curr_segment_index - segment_first] = probSumH;
+			memcpy(Alpha + (curr_segment_index - segment_first) * HAP_NUMBER * n_cond_haps, prob, HAP_NUMBER * n_cond_haps * sizeof(double));
+			memcpy(AlphaSum + (curr_segment_index - segment_first) * HAP_NUMBER, probSumH, HAP_NUMBER * sizeof(double));
 			AlphaSumSum[curr_segment_index - segment_first] = probSumT;
 			AlphaLocus[curr_segment_index - segment_first] = prev_abs_locus;
 		}
 		if (mis) {
-			AlphaMissing[curr_rel_missing] = prob;
-			AlphaSumMissing[curr_rel_missing] = probSumH;
+			memcpy(AlphaMissing + curr_rel_missing * HAP_NUMBER * n_cond_haps, prob, HAP_NUMBER * n_cond_haps * sizeof(double));
+			memcpy(AlphaSumMissing + curr_rel_missing * HAP_NUMBER, probSumH, HAP_NUMBER * sizeof(double));
 			curr_abs_missing ++;
 		}
-
-		curr_segment_locus ++;
 		curr_abs_ambiguous += amb;
-		if (curr_segment_locus >= G->Lengths[curr_segment_index]) {
-			curr_segment_index++;
-			curr_segment_locus = 0;
-		}
 	}
 }
 
 int haplotype_segment_double::backward(vector < double > & transition_probabilities, vector < float > & missing_probabilities) {
 	int n_underflow_recovered = 0;
 	curr_segment_index = segment_last;
-	curr_segment_locus = G->Lengths[segment_last] - 1;
+	curr_segment_start = locus_last - G->Lengths[segment_last] + 1;
 	curr_abs_ambiguous = ambiguous_last;
 	curr_abs_missing = missing_last;
 	curr_abs_transition = transition_last;
 	prev_abs_locus = locus_last;
 
-	for (curr_abs_locus = locus_last ; curr_abs_locus >= locus_first ; curr_abs_locus--) {
+	for (int e = n_events - 1 ; e >= 0 ; e --) {
+		curr_abs_locus = Events[e];
+		while (curr_abs_locus < curr_segment_start) curr_segment_start -= G->Lengths[--curr_segment_index];
+		curr_segment_locus = curr_abs_locus - curr_segment_start;
 		curr_rel_locus = curr_abs_locus - locus_first;
 		curr_rel_missing = curr_abs_missing - missing_first;
 		char rare_allele = M.rare_allele[curr_abs_locus];
@@ -182,14 +195,7 @@ int haplotype_segment_double::backward(vector < double > & transition_probabilit
 			IMPUTE(missing_probabilities);
 			curr_abs_missing--;
 		}
-
-
-		curr_segment_locus--;
 		curr_abs_ambiguous -= amb;
-		if (curr_segment_locus < 0 && curr_segment_index > 0) {
-			curr_segment_index--;
-			curr_segment_locus = G->Lengths[curr_segment_index] - 1;
-		}
 	}
 	return n_underflow_recovered;
 }
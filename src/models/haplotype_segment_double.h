@@ -31,7 +31,7 @@ private:
 	//EXTERNAL DATA
 	hmm_parameters & M;
 	genotype * G;
-	bitmatrix Hhap, Hvar;
+	bitmatrix & Hvar;	//Variant-major tile of the conditioning haplotypes [per-thread buffer]
 
 	//COORDINATES & CONSTANTS
 	int segment_first;
@@ -58,19 +58,25 @@ private:
 	int curr_abs_transition;
 	int curr_abs_missing;
 	int curr_rel_missing;
+	int curr_segment_start;
 
+	//EVENTS [loci that change the HMM state: all but homozygous genotypes carrying the common allele of rare variants, plus segment boundaries, taken from the workspace]
+	int * Events;
+	int n_events;
 
-	//DYNAMIC ARRAYS
+
+	//DYNAMIC ARRAYS [flat blocks of the per-thread workspace]
+	workspace_arena & Work;
 	double probSumT;
-	vector < double > prob;
-	vector < double > probSumK;
-	vector < double > probSumH;
-	vector < vector < double > > Alpha;
-	vector < vector < double > > AlphaSum;
-	vector < int > AlphaLocus;
-	vector < double > AlphaSumSum;
-	vector < vector < double > > AlphaMissing;
-	vector < vector < double > > AlphaSumMissing;
+	double * prob;
+	double * probSumK;
+	double * probSumH;
+	double * Alpha;				//[segment x HAP_NUMBER * n_cond_haps]
+	double * AlphaSum;			//[segment x HAP_NUMBER]
+	int * AlphaLocus;
+	double * AlphaSumSum;
+	double * AlphaMissing;		//[missing x HAP_NUMBER * n_cond_haps]
+	double * AlphaSumMissing;	//[missing x HAP_NUMBER]
 	double HProbs [HAP_NUMBER * HAP_NUMBER];
 	double DProbs [HAP_NUMBER * HAP_NUMBER * HAP_NUMBER * HAP_NUMBER];
 
@@ -100,10 +106,11 @@ private:
 
 public:
 	//CONSTRUCTOR/DESTRUCTOR
-	haplotype_segment_double(genotype *, bitmatrix &, vector < unsigned int > &, coordinates &, hmm_parameters &);
+	haplotype_segment_double(genotype *, bitmatrix &, vector < unsigned int > &, coordinates &, hmm_parameters &, bitmatrix &, workspace_arena &);
 	~haplotype_segment_double();
 
 	//void fetch();
+	void buildEvents();
 	void forward();
 	int backward(vector < double > &, vector < float > &);
 };
@@ -115,10 +122,10 @@ public:
 inline
 void haplotype_segment_double::INIT_HOM() {
 	bool ag = VAR_GET_HAP0(MOD2(curr_abs_locus), G->Variants[DIV2(curr_abs_locus)]);
-	fill(probSumH.begin(), probSumH.begin()+HAP_NUMBER, 0.0f);
+	fill(probSumH, probSumH+HAP_NUMBER, 0.0f);
 	for(int k = 0, i = 0 ; k != n_cond_haps ; ++k, i += HAP_NUMBER) {
 		bool ah = Hvar.get(curr_rel_locus+curr_rel_locus_offset, k);
-		fill(prob.begin()+i, prob.begin()+i+HAP_NUMBER, (ag==ah)?1.0f:M.ed/M.ee);
+		fill(prob+i, prob+i+HAP_NUMBER, (ag==ah)?1.0f:M.ed/M.ee);
 		for (int h = 0 ; h < HAP_NUMBER ; h ++) probSumH[h] += prob[i+h];
 	}
 	probSumT = probSumH[0] + probSumH[1] + probSumH[2] + probSumH[3] + probSumH[4] + probSumH[5] + probSumH[6] + probSumH[7];
@@ -132,7 +139,7 @@ bool haplotype_segment_double::RUN_HOM(char rare_allele) {
 		for (int h = 0 ; h < HAP_NUMBER ; h++) _tFreq[h] *= probSumH[h];
 		double _nt = nt / probSumT;
 		double _mismatch = M.ed/M.ee;
-		fill(probSumH.begin(), probSumH.begin()+HAP_NUMBER, 0.0f);
+		fill(probSumH, probSumH+HAP_NUMBER, 0.0f);
 		for(int k = 0, i = 0 ; k != n_cond_haps ; ++k, i += HAP_NUMBER) {
 			bool ah = Hvar.get(curr_rel_locus+curr_rel_locus_offset, k);
 			for (int h = 0 ; h < HAP_NUMBER ; h++) prob[i+h] = (prob[i+h]*_nt)+_tFreq[h];
@@ -148,13 +155,13 @@ bool haplotype_segment_double::RUN_HOM(char rare_allele) {
 inline
 void haplotype_segment_double::COLLAPSE_HOM() {
 	bool ag = VAR_GET_HAP0(MOD2(curr_abs_locus), G->Variants[DIV2(curr_abs_locus)]);
-	fill(probSumH.begin(), probSumH.begin()+HAP_NUMBER, 0.0f);
+	fill(probSumH, probSumH+HAP_NUMBER, 0.0f);
 	double _tFreq = yt / n_cond_haps;					////Check divide by probSumT here!
 	double _nt = nt / probSumT;
 	double _mismatch = M.ed/M.ee;
 	for(int k = 0, i = 0 ; k != n_cond_haps ; ++k, i += HAP_NUMBER) {
 		bool ah = Hvar.get(curr_rel_locus+curr_rel_locus_offset, k);
-		fill(prob.begin()+i, prob.begin()+i+HAP_NUMBER, (ag==ah)?((probSumK[k]*_nt)+_tFreq):(((probSumK[k]*_nt)+_tFreq)*_mismatch));
+		fill(prob+i, prob+i+HAP_NUMBER, (ag==ah)?((probSumK[k]*_nt)+_tFreq):(((probSumK[k]*_nt)+_tFreq)*_mismatch));
 		for (int h = 0 ; h < HAP_NUMBER ; h ++) probSumH[h] += prob[i+h];
 	}
 	probSumT = probSumH[0] + probSumH[1] + probSumH[2] + probSumH[3] + probSumH[4] + probSumH[5] + probSumH[6] + probSumH[7];
@@ -171,7 +178,7 @@ void haplotype_segment_double::INIT_AMB() {
 		g0[h] = HAP_GET(amb_code,h)?M.ed/M.ee:1.0f;
 		g1[h] = HAP_GET(amb_code,h)?1.0f:M.ed/M.ee;
 	}
-	fill(probSumH.begin(), probSumH.begin()+HAP_NUMBER, 0.0f);
+	fill(probSumH, probSumH+HAP_NUMBER, 0.0f);
 	for(int k = 0, i = 0 ; k != n_cond_haps ; ++k, i += HAP_NUMBER) {
 		bool ah = Hvar.get(curr_rel_locus+curr_rel_locus_offset, k);
 		if (ah) memcpy(&prob[i], &g1[0], HAP_NUMBER*sizeof(double));
@@ -193,7 +200,7 @@ void haplotype_segment_double::RUN_AMB() {
 	for (int h = 0 ; h < HAP_NUMBER ; h++) _tFreq[h] *= probSumH[h];
 	//double _nt = M.nt[curr_abs_locus-forward] / probSumT;
 	double _nt = nt / probSumT;
-	fill(probSumH.begin(), probSumH.begin()+HAP_NUMBER, 0.0f);
+	fill(probSumH, probSumH+HAP_NUMBER, 0.0f);
 	for(int k = 0, i = 0 ; k != n_cond_haps ; ++k, i += HAP_NUMBER) {
 		bool ah = Hvar.get(curr_rel_locus+curr_rel_locus_offset, k);
 		for (int h = 0 ; h < HAP_NUMBER ; h++) prob[i+h] = (prob[i+h]*_nt)+_tFreq[h];
@@ -214,10 +221,10 @@ void haplotype_segment_double::COLLAPSE_AMB() {
 	double _tFreq = yt / n_cond_haps;
 	//double _nt = M.nt[curr_abs_locus-forward] / probSumT;
 	double _nt = nt / probSumT;
-	fill(probSumH.begin(), probSumH.begin()+HAP_NUMBER, 0.0f);
+	fill(probSumH, probSumH+HAP_NUMBER, 0.0f);
 	for(int k = 0, i = 0 ; k != n_cond_haps ; ++k, i += HAP_NUMBER) {
 		bool ah = Hvar.get(curr_rel_locus+curr_rel_locus_offset, k);
-		fill(prob.begin()+i, prob.begin()+i+HAP_NUMBER, (probSumK[k]*_nt)+_tFreq);
+		fill(prob+i, prob+i+HAP_NUMBER, (probSumK[k]*_nt)+_tFreq);
 		for (int h = 0 ; h < HAP_NUMBER ; h++) prob[i+h] *= ah?g1[h]:g0[h];
 		for (int h = 0 ; h < HAP_NUMBER ; h++) probSumH[h] += prob[i+h];
 	}
@@ -230,8 +237,8 @@ void haplotype_segment_double::COLLAPSE_AMB() {
 
 inline
 void haplotype_segment_double::INIT_MIS() {
-	fill(prob.begin(), prob.end(), 1.0f/(HAP_NUMBER * n_cond_haps));
-	fill(probSumH.begin(), probSumH.end(), 1.0f/HAP_NUMBER);
+	fill(prob, prob + HAP_NUMBER * n_cond_haps, 1.0f/(HAP_NUMBER * n_cond_haps));
+	fill(probSumH, probSumH + HAP_NUMBER, 1.0f/HAP_NUMBER);
 	probSumT = 1.0f;
 }
 
@@ -242,7 +249,7 @@ void haplotype_segment_double::RUN_MIS() {
 	for (int h = 0 ; h < HAP_NUMBER ; h++) _tFreq[h] *= probSumH[h];
 	//double _nt = M.nt[curr_abs_locus-forward] / probSumT;
 	double _nt = nt / probSumT;
-	fill(probSumH.begin(), probSumH.begin()+HAP_NUMBER, 0.0f);
+	fill(probSumH, probSumH+HAP_NUMBER, 0.0f);
 	for(int k = 0, i = 0 ; k != n_cond_haps ; ++k, i += HAP_NUMBER) {
 		for (int h = 0 ; h < HAP_NUMBER ; h++) prob[i+h] = (prob[i+h]*_nt)+_tFreq[h];
 		for (int h = 0 ; h < HAP_NUMBER ; h++) probSumH[h] += prob[i+h];
@@ -256,9 +263,9 @@ void haplotype_segment_double::COLLAPSE_MIS() {
 	double _tFreq = yt / n_cond_haps;
 	//double _nt = M.nt[curr_abs_locus-forward] / probSumT;
 	double _nt = nt / probSumT;
-	fill(probSumH.begin(), probSumH.begin()+HAP_NUMBER, 0.0f);
+	fill(probSumH, probSumH+HAP_NUMBER, 0.0f);
 	for(int k = 0, i = 0 ; k != n_cond_haps ; ++k, i += HAP_NUMBER) {
-		fill(prob.begin()+i, prob.begin()+i+HAP_NUMBER, (probSumK[k]*_nt)+_tFreq);
+		fill(prob+i, prob+i+HAP_NUMBER, (probSumK[k]*_nt)+_tFreq);
 		for (int h = 0 ; h < HAP_NUMBER ; h++) probSumH[h] += prob[i+h];
 	}
 	probSumT = probSumH[0] + probSumH[1] + probSumH[2] + probSumH[3] + probSumH[4] + probSumH[5] + probSumH[6] + probSumH[7];
@@ -290,10 +297,10 @@ bool haplotype_segment_double::TRANS_HAP() {
 	double fact1 = nt / AlphaSumSum[curr_rel_segment_index - 1];
 	fill_n(HProbs, HAP_NUMBER*HAP_NUMBER, 0.0f);
 	for (int h1 = 0 ; h1 < HAP_NUMBER ; h1++) {
-		//double fact2 = (AlphaSum[curr_rel_segment_index-1][h1]/AlphaSumSum[curr_rel_segment_index-1]) * M.t[curr_abs_locus - 1] / n_cond_haps;
-		double fact2 = (AlphaSum[curr_rel_segment_index-1][h1]/AlphaSumSum[curr_rel_segment_index-1]) * yt / n_cond_haps;
+		//double fact2 = (AlphaSum[(curr_rel_segment_index-1)*HAP_NUMBER + h1]/AlphaSumSum[curr_rel_segment_index-1]) * M.t[curr_abs_locus - 1] / n_cond_haps;
+		double fact2 = (AlphaSum[(curr_rel_segment_index-1)*HAP_NUMBER + h1]/AlphaSumSum[curr_rel_segment_index-1]) * yt / n_cond_haps;
 		for (int k = 0 ; k < n_cond_haps ; k ++) {
-			for (int h2 = 0 ; h2 < HAP_NUMBER ; h2++) HProbs[h1*HAP_NUMBER+h2]+=((Alpha[curr_rel_segment_index-1][k*HAP_NUMBER + h1]*fact1 + fact2)*prob[k*HAP_NUMBER+h2]);
+			for (int h2 = 0 ; h2 < HAP_NUMBER ; h2++) HProbs[h1*HAP_NUMBER+h2]+=((Alpha[(curr_rel_segment_index-1)*HAP_NUMBER*n_cond_haps + k*HAP_NUMBER + h1]*fact1 + fact2)*prob[k*HAP_NUMBER+h2]);
 		}
 		sumHProbs += HProbs[h1*HAP_NUMBER+0]+HProbs[h1*HAP_NUMBER+1]+HProbs[h1*HAP_NUMBER+2]+HProbs[h1*HAP_NUMBER+3]+HProbs[h1*HAP_NUMBER+4]+HProbs[h1*HAP_NUMBER+5]+HProbs[h1*HAP_NUMBER+6]+HProbs[h1*HAP_NUMBER+7];
 	}
@@ -339,11 +346,11 @@ bool haplotype_segment_double::TRANS_DIP_ADD() {
 inline
 void haplotype_segment_double::IMPUTE(vector < float > & missing_probabilities) {
 	vector < vector < double > > _sumA = vector < vector < double > > (2, vector < double > (HAP_NUMBER, 0.0f));
-	vector < double > _scale = AlphaSumMissing[curr_rel_missing];
+	vector < double > _scale = vector < double > (AlphaSumMissing + curr_rel_missing*HAP_NUMBER, AlphaSumMissing + (curr_rel_missing+1)*HAP_NUMBER);
 	for (int h = 0 ; h < HAP_NUMBER ; h++) _scale[h] = 1.0f / _scale[h];
 	for(int k = 0, i = 0 ; k != n_cond_haps ; ++k, i += HAP_NUMBER) {
 		bool ah = Hvar.get(curr_rel_locus+curr_rel_locus_offset, k);
-		for (int h = 0 ; h < HAP_NUMBER ; h++) _sumA[ah][h] += (AlphaMissing[curr_rel_missing][i+h]*_scale[h])*prob[i+h];
+		for (int h = 0 ; h < HAP_NUMBER ; h++) _sumA[ah][h] += (AlphaMissing[curr_rel_missing*HAP_NUMBER*n_cond_haps + i+h]*_scale[h])*prob[i+h];
 	}
 	for (int h = 0 ; h < HAP_NUMBER ; h ++) missing_probabilities[curr_abs_missing * HAP_NUMBER + h] = _sumA[1][h] / (_sumA[0][h]+_sumA[1][h]);
 }
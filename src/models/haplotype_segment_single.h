@@ -29,10 +29,6 @@
 #ifdef __AVX2__
 
 #include <immintrin.h>
-#include <boost/align/aligned_allocator.hpp>
-
-template <typename T>
-using aligned_vector32 = std::vector<T, boost::alignment::aligned_allocator < T, 32 > >;
 
 #endif
 
@@ -41,7 +37,7 @@ private:
 	//EXTERNAL DATA
 	hmm_parameters & M;
 	genotype * G;
-	bitmatrix Hhap, Hvar;
+	bitmatrix & Hvar;	//Variant-major tile of the conditioning haplotypes [per-thread buffer]
 
 	//COORDINATES & CONSTANTS
 	int segment_first;
@@ -68,32 +64,29 @@ private:
 	int curr_abs_transition;
 	int curr_abs_missing;
 	int curr_rel_missing;
+	int curr_segment_start;
+
+	//EVENTS [loci that change the HMM state: all but homozygous genotypes carrying the common allele of rare variants, plus segment boundaries, taken from the workspace]
+	int * Events;
+	int n_events;
 
 
-	//DYNAMIC ARRAYS
+	//DYNAMIC ARRAYS [flat blocks of the per-thread workspace, 32-byte aligned]
+	workspace_arena & Work;
 	float probSumT;
+	float * prob;
+	float * probSumK;
+	float * probSumH;
+	float * Alpha;				//[segment x HAP_NUMBER * n_cond_haps]
+	float * AlphaSum;			//[segment x HAP_NUMBER]
+	int * AlphaLocus;
+	float * AlphaSumSum;
+	float * AlphaMissing;		//[missing x HAP_NUMBER * n_cond_haps]
+	float * AlphaSumMissing;	//[missing x HAP_NUMBER]
 #ifdef __AVX2__
-	aligned_vector32 < float > prob;
-	aligned_vector32 < float > probSumK;
-	aligned_vector32 < float > probSumH;
-	vector < aligned_vector32 < float > > Alpha;
-	vector < aligned_vector32 < float > > AlphaSum;
-	vector < int > AlphaLocus;
-	aligned_vector32 < float > AlphaSumSum;
-	vector < aligned_vector32 < float > > AlphaMissing;
-	vector < aligned_vector32 < float > > AlphaSumMissing;
 	float HProbs [HAP_NUMBER * HAP_NUMBER] __attribute__ ((aligned(32)));
 	double DProbs [HAP_NUMBER * HAP_NUMBER * HAP_NUMBER * HAP_NUMBER] __attribute__ ((aligned(32)));
 #else
-	vector < float > prob;
-	vector < float > probSumK;
-	vector < float > probSumH;
-	vector < vector < float > > Alpha;
-	vector < vector < float > > AlphaSum;
-	vector < int > AlphaLocus;
-	vector < float > AlphaSumSum;
-	vector < vector < float > > AlphaMissing;
-	vector < vector < float > > AlphaSumMissing;
 	float HProbs [HAP_NUMBER * HAP_NUMBER];
 	double DProbs [HAP_NUMBER * HAP_NUMBER * HAP_NUMBER * HAP_NUMBER];
 #endif
@@ -124,10 +117,11 @@ private:
 
 public:
 	//CONSTRUCTOR/DESTRUCTOR
-	haplotype_segment_single(genotype *, bitmatrix &, vector < unsigned int > &, coordinates &, hmm_parameters &);
+	haplotype_segment_single(genotype *, bitmatrix &, vector < unsigned int > &, coordinates &, hmm_parameters &, bitmatrix &, workspace_arena &);
 	~haplotype_segment_single();
 
 	//void fetch();
+	void buildEvents();
 	void forward();
 	int backward(vector < double > &, vector < float > &);
 };
@@ -154,10 +148,10 @@ void haplotype_segment_single::INIT_HOM() {
 inline
 void haplotype_segment_single::INIT_HOM() {
 	bool ag = VAR_GET_HAP0(MOD2(curr_abs_locus), G->Variants[DIV2(curr_abs_locus)]);
-	fill(probSumH.begin(), probSumH.begin()+HAP_NUMBER, 0.0f);
+	fill(probSumH, probSumH+HAP_NUMBER, 0.0f);
 	for(int k = 0, i = 0 ; k != n_cond_haps ; ++k, i += HAP_NUMBER) {
 		bool ah = Hvar.get(curr_rel_locus+curr_rel_locus_offset, k);
-		fill(prob.begin()+i, prob.begin()+i+HAP_NUMBER, (ag==ah)?1.0f:M.ed/M.ee);
+		fill(prob+i, prob+i+HAP_NUMBER, (ag==ah)?1.0f:M.ed/M.ee);
 		for (int h = 0 ; h < HAP_NUMBER ; h ++) probSumH[h] += prob[i+h];
 	}
 	probSumT = probSumH[0] + probSumH[1] + probSumH[2] + probSumH[3] + probSumH[4] + probSumH[5] + probSumH[6] + probSumH[7];
@@ -202,7 +196,7 @@ bool haplotype_segment_single::RUN_HOM(char rare_allele) {
 		//float _nt = M.nt[curr_abs_locus-forward] / probSumT;
 		float _nt = nt / probSumT;
 		float _mismatch = M.ed/M.ee;
-		fill(probSumH.begin(), probSumH.begin()+HAP_NUMBER, 0.0f);
+		fill(probSumH, probSumH+HAP_NUMBER, 0.0f);
 		for(int k = 0, i = 0 ; k != n_cond_haps ; ++k, i += HAP_NUMBER) {
 			bool ah = Hvar.get(curr_rel_locus+curr_rel_locus_offset, k);
 			for (int h = 0 ; h < HAP_NUMBER ; h++) prob[i+h] = (prob[i+h]*_nt)+_tFreq[h];
@@ -241,7 +235,7 @@ void haplotype_segment_single::COLLAPSE_HOM() {
 inline
 void haplotype_segment_single::COLLAPSE_HOM() {
 	bool ag = VAR_GET_HAP0(MOD2(curr_abs_locus), G->Variants[DIV2(curr_abs_locus)]);
-	fill(probSumH.begin(), probSumH.begin()+HAP_NUMBER, 0.0f);
+	fill(probSumH, probSumH+HAP_NUMBER, 0.0f);
 	//float _tFreq = M.t[curr_abs_locus-forward] / n_cond_haps;
 	float _tFreq = yt / n_cond_haps;					////Check divide by probSumT here!
 	//float _nt = M.nt[curr_abs_locus-forward] / probSumT;
@@ -249,7 +243,7 @@ void haplotype_segment_single::COLLAPSE_HOM() {
 	float _mismatch = M.ed/M.ee;
 	for(int k = 0, i = 0 ; k != n_cond_haps ; ++k, i += HAP_NUMBER) {
 		bool ah = Hvar.get(curr_rel_locus+curr_rel_locus_offset, k);
-		fill(prob.begin()+i, prob.begin()+i+HAP_NUMBER, (ag==ah)?((probSumK[k]*_nt)+_tFreq):(((probSumK[k]*_nt)+_tFreq)*_mismatch));
+		fill(prob+i, prob+i+HAP_NUMBER, (ag==ah)?((probSumK[k]*_nt)+_tFreq):(((probSumK[k]*_nt)+_tFreq)*_mismatch));
 		for (int h = 0 ; h < HAP_NUMBER ; h ++) probSumH[h] += prob[i+h];
 	}
 	probSumT = probSumH[0] + probSumH[1] + probSumH[2] + probSumH[3] + probSumH[4] + probSumH[5] + probSumH[6] + probSumH[7];
@@ -288,7 +282,7 @@ void haplotype_segment_single::INIT_AMB() {
 		g0[h] = HAP_GET(amb_code,h)?M.ed/M.ee:1.0f;
 		g1[h] = HAP_GET(amb_code,h)?1.0f:M.ed/M.ee;
 	}
-	fill(probSumH.begin(), probSumH.begin()+HAP_NUMBER, 0.0f);
+	fill(probSumH, probSumH+HAP_NUMBER, 0.0f);
 	for(int k = 0, i = 0 ; k != n_cond_haps ; ++k, i += HAP_NUMBER) {
 		bool ah = Hvar.get(curr_rel_locus+curr_rel_locus_offset, k);
 		if (ah) memcpy(&prob[i], &g1[0], HAP_NUMBER*sizeof(float));
@@ -339,7 +333,7 @@ void haplotype_segment_single::RUN_AMB() {
 	for (int h = 0 ; h < HAP_NUMBER ; h++) _tFreq[h] *= probSumH[h];
 	//float _nt = M.nt[curr_abs_locus-forward] / probSumT;
 	float _nt = nt / probSumT;
-	fill(probSumH.begin(), probSumH.begin()+HAP_NUMBER, 0.0f);
+	fill(probSumH, probSumH+HAP_NUMBER, 0.0f);
 	for(int k = 0, i = 0 ; k != n_cond_haps ; ++k, i += HAP_NUMBER) {
 		bool ah = Hvar.get(curr_rel_locus+curr_rel_locus_offset, k);
 		for (int h = 0 ; h < HAP_NUMBER ; h++) prob[i+h] = (prob[i+h]*_nt)+_tFreq[h];
@@ -387,10 +381,10 @@ void haplotype_segment_single::COLLAPSE_AMB() {
 	float _tFreq = yt / n_cond_haps;
 	//float _nt = M.nt[curr_abs_locus-forward] / probSumT;
 	float _nt = nt / probSumT;
-	fill(probSumH.begin(), probSumH.begin()+HAP_NUMBER, 0.0f);
+	fill(probSumH, probSumH+HAP_NUMBER, 0.0f);
 	for(int k = 0, i = 0 ; k != n_cond_haps ; ++k, i += HAP_NUMBER) {
 		bool ah = Hvar.get(curr_rel_locus+curr_rel_locus_offset, k);
-		fill(prob.begin()+i, prob.begin()+i+HAP_NUMBER, (probSumK[k]*_nt)+_tFreq);
+		fill(prob+i, prob+i+HAP_NUMBER, (probSumK[k]*_nt)+_tFreq);
 		for (int h = 0 ; h < HAP_NUMBER ; h++) prob[i+h] *= ah?g1[h]:g0[h];
 		for (int h = 0 ; h < HAP_NUMBER ; h++) probSumH[h] += prob[i+h];
 	}
@@ -404,8 +398,8 @@ void haplotype_segment_single::COLLAPSE_AMB() {
 
 inline
 void haplotype_segment_single::INIT_MIS() {
-	fill(prob.begin(), prob.end(), 1.0f/(HAP_NUMBER * n_cond_haps));
-	fill(probSumH.begin(), probSumH.end(), 1.0f/HAP_NUMBER);
+	fill(prob, prob + HAP_NUMBER * n_cond_haps, 1.0f/(HAP_NUMBER * n_cond_haps));
+	fill(probSumH, probSumH + HAP_NUMBER, 1.0f/HAP_NUMBER);
 	probSumT = 1.0f;
 }
 
@@ -436,7 +430,7 @@ void haplotype_segment_single::RUN_MIS() {
 	for (int h = 0 ; h < HAP_NUMBER ; h++) _tFreq[h] *= probSumH[h];
 	//float _nt = M.nt[curr_abs_locus-forward] / probSumT;
 	float _nt = nt / probSumT;
-	fill(probSumH.begin(), probSumH.begin()+HAP_NUMBER, 0.0f);
+	fill(probSumH, probSumH+HAP_NUMBER, 0.0f);
 	for(int k = 0, i = 0 ; k != n_cond_haps ; ++k, i += HAP_NUMBER) {
 		for (int h = 0 ; h < HAP_NUMBER ; h++) prob[i+h] = (prob[i+h]*_nt)+_tFreq[h];
 		for (int h = 0 ; h < HAP_NUMBER ; h++) probSumH[h] += prob[i+h];
@@ -469,9 +463,9 @@ void haplotype_segment_single::COLLAPSE_MIS() {
 	float _tFreq = yt / n_cond_haps;
 	//float _nt = M.nt[curr_abs_locus-forward] / probSumT;
 	float _nt = nt / probSumT;
-	fill(probSumH.begin(), probSumH.begin()+HAP_NUMBER, 0.0f);
+	fill(probSumH, probSumH+HAP_NUMBER, 0.0f);
 	for(int k = 0, i = 0 ; k != n_cond_haps ; ++k, i += HAP_NUMBER) {
-		fill(prob.begin()+i, prob.begin()+i+HAP_NUMBER, (probSumK[k]*_nt)+_tFreq);
+		fill(prob+i, prob+i+HAP_NUMBER, (probSumK[k]*_nt)+_tFreq);
 		for (int h = 0 ; h < HAP_NUMBER ; h++) probSumH[h] += prob[i+h];
 	}
 	probSumT = probSumH[0] + probSumH[1] + probSumH[2] + probSumH[3] + probSumH[4] + probSumH[5] + probSumH[6] + probSumH[7];
@@ -504,10 +498,10 @@ bool haplotype_segment_single::TRANS_HAP() {
 	float fact1 = nt / AlphaSumSum[curr_rel_segment_index - 1];
 	for (int h1 = 0 ; h1 < HAP_NUMBER ; h1++) {
 		__m256 _sum = _mm256_set1_ps(0.0f);
-		//float fact2 = (AlphaSum[curr_rel_segment_index-1][h1]/AlphaSumSum[curr_rel_segment_index-1]) * M.t[curr_abs_locus - 1] / n_cond_haps;
-		float fact2 = (AlphaSum[curr_rel_segment_index-1][h1]/AlphaSumSum[curr_rel_segment_index-1]) * yt / n_cond_haps;
+		//float fact2 = (AlphaSum[(curr_rel_segment_index-1)*HAP_NUMBER + h1]/AlphaSumSum[curr_rel_segment_index-1]) * M.t[curr_abs_locus - 1] / n_cond_haps;
+		float fact2 = (AlphaSum[(curr_rel_segment_index-1)*HAP_NUMBER + h1]/AlphaSumSum[curr_rel_segment_index-1]) * yt / n_cond_haps;
 		for (int k = 0 ; k < n_cond_haps ; k ++) {
-			__m256 _alpha = _mm256_set1_ps(Alpha[curr_rel_segment_index-1][k*HAP_NUMBER + h1] * fact1 + fact2);
+			__m256 _alpha = _mm256_set1_ps(Alpha[(curr_rel_segment_index-1)*HAP_NUMBER*n_cond_haps + k*HAP_NUMBER + h1] * fact1 + fact2);
 			__m256 _beta = _mm256_load_ps(&prob[k*HAP_NUMBER]);
 			_sum = _mm256_add_ps(_sum, _mm256_mul_ps(_alpha, _beta));
 		}
@@ -527,10 +521,10 @@ bool haplotype_segment_single::TRANS_HAP() {
 	float fact1 = nt / AlphaSumSum[curr_rel_segment_index - 1];
 	fill_n(HProbs, HAP_NUMBER*HAP_NUMBER, 0.0f);
 	for (int h1 = 0 ; h1 < HAP_NUMBER ; h1++) {
-		//float fact2 = (AlphaSum[curr_rel_segment_index-1][h1]/AlphaSumSum[curr_rel_segment_index-1]) * M.t[curr_abs_locus - 1] / n_cond_haps;
-		float fact2 = (AlphaSum[curr_rel_segment_index-1][h1]/AlphaSumSum[curr_rel_segment_index-1]) * yt / n_cond_haps;
+		//float fact2 = (AlphaSum[(curr_rel_segment_index-1)*HAP_NUMBER + h1]/AlphaSumSum[curr_rel_segment_index-1]) * M.t[curr_abs_locus - 1] / n_cond_haps;
+		float fact2 = (AlphaSum[(curr_rel_segment_index-1)*HAP_NUMBER + h1]/AlphaSumSum[curr_rel_segment_index-1]) * yt / n_cond_haps;
 		for (int k = 0 ; k < n_cond_haps ; k ++) {
-			for (int h2 = 0 ; h2 < HAP_NUMBER ; h2++) HProbs[h1*HAP_NUMBER+h2]+=((Alpha[curr_rel_segment_index-1][k*HAP_NUMBER + h1]*fact1 + fact2)*prob[k*HAP_NUMBER+h2]);
+			for (int h2 = 0 ; h2 < HAP_NUMBER ; h2++) HProbs[h1*HAP_NUMBER+h2]+=((Alpha[(curr_rel_segment_index-1)*HAP_NUMBER*n_cond_haps + k*HAP_NUMBER + h1]*fact1 + fact2)*prob[k*HAP_NUMBER+h2]);
 		}
 		sumHProbs += HProbs[h1*HAP_NUMBER+0]+HProbs[h1*HAP_NUMBER+1]+HProbs[h1*HAP_NUMBER+2]+HProbs[h1*HAP_NUMBER+3]+HProbs[h1*HAP_NUMBER+4]+HProbs[h1*HAP_NUMBER+5]+HProbs[h1*HAP_NUMBER+6]+HProbs[h1*HAP_NUMBER+7];
 	}
@@ -579,13 +573,13 @@ inline
 void haplotype_segment_single::IMPUTE(vector < float > & missing_probabilities) {
 	__m256 _sum = _mm256_set1_ps(0.0f);
 	__m256 _sumA [2]; _sumA[0] = _mm256_set1_ps(0.0f); _sumA[1] = _mm256_set1_ps(0.0f);
-	__m256 _alphaSum = _mm256_load_ps(&AlphaSumMissing[curr_rel_missing][0]);
+	__m256 _alphaSum = _mm256_load_ps(&AlphaSumMissing[curr_rel_missing*HAP_NUMBER]);
 	__m256 _ones = _mm256_set1_ps(1.0f);
 	_alphaSum = _mm256_div_ps(_ones, _alphaSum);
 	for(int k = 0, i = 0 ; k != n_cond_haps ; ++k, i += HAP_NUMBER) {
 		bool ah = Hvar.get(curr_rel_locus+curr_rel_locus_offset, k);
 		__m256 _prob = _mm256_load_ps(&prob[i]);
-		__m256 _alpha = _mm256_load_ps(&AlphaMissing[curr_rel_missing][i]);
+		__m256 _alpha = _mm256_load_ps(&AlphaMissing[curr_rel_missing*HAP_NUMBER*n_cond_haps + i]);
 		_sum = _mm256_mul_ps(_mm256_mul_ps(_alpha, _alphaSum), _prob);
 		_sumA[ah] = _mm256_add_ps(_sumA[ah], _sum);
 	}
@@ -599,11 +593,11 @@ void haplotype_segment_single::IMPUTE(vector < float > & missing_probabilities)
 inline
 void haplotype_segment_single::IMPUTE(vector < float > & missing_probabilities) {
 	vector < vector < float > > _sumA = vector < vector < float > > (2, vector < float > (HAP_NUMBER, 0.0f));
-	vector < float > _scale = AlphaSumMissing[curr_rel_missing];
+	vector < float > _scale = vector < float > (AlphaSumMissing + curr_rel_missing*HAP_NUMBER, AlphaSumMissing + (curr_rel_missing+1)*HAP_NUMBER);
 	for (int h = 0 ; h < HAP_NUMBER ; h++) _scale[h] = 1.0f / _scale[h];
 	for(int k = 0, i = 0 ; k != n_cond_haps ; ++k, i += HAP_NUMBER) {
 		bool ah = Hvar.get(curr_rel_locus+curr_rel_locus_offset, k);
-		for (int h = 0 ; h < HAP_NUMBER ; h++) _sumA[ah][h] += (AlphaMissing[curr_rel_missing][i+h]*_scale[h])*prob[i+h];
+		for (int h = 0 ; h < HAP_NUMBER ; h++) _sumA[ah][h] += (AlphaMissing[curr_rel_missing*HAP_NUMBER*n_cond_haps + i+h]*_scale[h])*prob[i+h];
 	}
 	for (int h = 0 ; h < HAP_NUMBER ; h ++) missing_probabilities[curr_abs_missing * HAP_NUMBER + h] = _sumA[1][h] / (_sumA[0][h]+_sumA[1][h]);
 }
@@ -62,6 +62,7 @@ void builder::build() {
 		for (int t = 0 ; t < n_thread ; t++) pthread_join( id_workers[t] , NULL);
 	} else for (int i = 0 ; i  <  G.n_ind ; i ++) build(i);
 	long int n_segments = G.numberOfSegments();
-	vrb.bullet("Build genotype graphs [seg=" + stb.str(n_segments) + "] (" + stb.str(tac.rel_time()*0.001, 2) + "s)");
+	double build_time = tac.rel_time(), n_mvariants = G.n_ind * 1.0 * G.n_site / 1e6;
+	vrb.bullet("Build genotype graphs [seg=" + stb.str(n_segments) + " / " + stb.str(n_mvariants > 0 ? build_time / n_mvariants : 0.0, 2) + "ms/Mvar] (" + stb.str(build_time*0.001, 2) + "s)");
 }
 
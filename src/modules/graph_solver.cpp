@@ -0,0 +1,73 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+#include <modules/graph_solver.h>
+
+graph_solver::graph_solver(genotype_set & _G, int n_thread): G(_G) {
+	this->n_thread = n_thread;
+	Backtrack = vector < vector < unsigned char > > (n_thread);
+	DipSampled = vector < vector < unsigned char > > (n_thread);
+	if (n_thread > 1) {
+		i_workers = 0;
+		i_jobs = 0;
+		id_workers = vector < pthread_t > (n_thread);
+		pthread_mutex_init(&mutex_workers, NULL);
+	}
+}
+
+graph_solver::~graph_solver() {
+	if (n_thread > 1) {
+		i_workers = 0;
+		i_jobs = 0;
+		pthread_mutex_destroy(&mutex_workers);
+		id_workers.clear();
+	}
+	Backtrack.clear();
+	DipSampled.clear();
+}
+
+void * graph_solver_callback(void * ptr) {
+	graph_solver * S = static_cast< graph_solver * >( ptr );
+	pthread_mutex_lock( &S->mutex_workers );
+	int id_worker = S->i_workers ++;
+	pthread_mutex_unlock( &S->mutex_workers );
+	for(;;) {
+		pthread_mutex_lock( &S->mutex_workers );
+		int id_job = S->i_jobs ++;
+		pthread_mutex_unlock( &S->mutex_workers );
+		if (id_job < S->G.n_ind) S->solve(id_worker, id_job);
+		else pthread_exit(NULL);
+	}
+	return NULL;
+}
+
+void graph_solver::solve(int id_worker, int ind) {
+	G.vecG[ind]->solve(Backtrack[id_worker], DipSampled[id_worker]);
+}
+
+void graph_solver::solve() {
+	tac.clock();
+	if (n_thread > 1) {
+		for (int t = 0 ; t < n_thread ; t++) pthread_create( &id_workers[t] , NULL, graph_solver_callback, static_cast<void *>(this));
+		for (int t = 0 ; t < n_thread ; t++) pthread_join( id_workers[t] , NULL);
+	} else for (int i = 0 ; i < G.n_ind ; i ++) solve(0, i);
+	vrb.bullet("HAP solving (" + stb.str(tac.rel_time()*1.0/1000, 2) + "s)");
+}
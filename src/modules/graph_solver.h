@@ -0,0 +1,52 @@
+/*******************************************************************************
+ * Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+#ifndef _GRAPH_SOLVER_H
+#define _GRAPH_SOLVER_H
+
+#include <utils/otools.h>
+#include <containers/genotype_set.h>
+
+class graph_solver {
+public:
+	//DATA
+	genotype_set & G;
+
+	//MULTI-THREADING
+	int i_workers, i_jobs;
+	int n_thread;
+	pthread_mutex_t mutex_workers;
+	vector < pthread_t > id_workers;
+
+	//PER-THREAD BUFFERS [Viterbi backtrack and best diplotypes, reused across samples]
+	vector < vector < unsigned char > > Backtrack;
+	vector < vector < unsigned char > > DipSampled;
+
+	//CONSTRUCTOR/DESTRUCTOR
+	graph_solver(genotype_set &, int n_thread = 1);
+	~graph_solver();
+
+	//METHODS
+	void solve();
+	void solve(int, int);
+};
+
+#endif
@@ -31,7 +31,7 @@ bool compute_job::reccursive_window_splitting(double min_length_cm, int left_ind
 	//A phasing window must (i) span >=4 segments, (ii) contain >= 100 variants and (iii) span more than "min_length_cm" cM
 	if (number_of_segments < 4 || number_of_variants < 100 || length_of_region < min_length_cm) return false;
 	else {
-		int split_point = rng.getInt(number_of_segments/2) + number_of_segments/4 + 1;
+		int split_point = R.getInt(number_of_segments/2) + number_of_segments/4 + 1;
 		vector <  int > left_output, right_output;
 		bool ret1 = reccursive_window_splitting(min_length_cm, left_index, left_index + split_point, idx_sta, idx_sto, ccm_sta, ccm_sto, left_output);
 		bool ret2 = reccursive_window_splitting(min_length_cm, left_index + split_point, right_index, idx_sta, idx_sto, ccm_sta, ccm_sto, right_output);
@@ -57,12 +57,26 @@ compute_job::compute_job(variant_map & _V, genotype_set & _G, haplotype_set & _H
 	O = vector < unsigned int > (H.n_hap);
 	iota(O.begin(), O.end(), 0);
 	Oiter = 0;
+	time_setup = 0.0;
+	time_hmm = 0.0;
+	time_busy = 0.0;
 }
 
 compute_job::~compute_job() {
 	free();
 }
 
+void compute_job::startCounters() {
+	PMU.open(false);
+	PMU.start();
+}
+
+void compute_job::stopCounters() {
+	pmu_counts = vector < long > (PMU_NUMBER, -1);
+	PMU.stop(pmu_counts.data());
+	PMU.close();
+}
+
 void compute_job::free () {
 	vector < double > ().swap(T);
 	vector < float > ().swap(M);
@@ -204,7 +218,8 @@ void compute_job::make(unsigned int ind, double min_window_size) {
 		}
 	}
 
-	//6. Add new random haps
+	//6. Add new random haps [from a position drawn for this job, so that it does not depend on the jobs previously run by this thread]
+	Oiter = R.getInt(H.n_hap);
 	for (int w = 0 ; w < n_windows; w++) {
 		if (nToBeRemoved[w] > 0) {
 			for (int k = 0 ; k < nToBeRemoved[w] ; k ++) {
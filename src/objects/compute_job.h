@@ -27,6 +27,9 @@
 #include <containers/haplotype_set.h>
 #include <containers/genotype_set.h>
 #include <containers/variant_map.h>
+#include <containers/bitmatrix.h>
+
+#include <chrono>
 
 class coordinates {
 public:
@@ -74,6 +77,19 @@ public:
 	}
 };
 
+#define TRACE_BUFFER_SIZE	4096
+
+//Cost of phasing one sample in one iteration [--hmm-trace]
+struct trace_event {
+	unsigned int ind;					//Sample index
+	unsigned int n_windows;				//Number of phasing windows
+	unsigned long n_cond;				//Conditioning haplotypes summed over windows
+	unsigned int n_transitions;
+	unsigned int n_missing;
+	bool double_precision;
+	unsigned long start_ns, elapsed_ns;	//Start relative to the start of the trace, duration
+};
+
 class compute_job {
 public:
 	variant_map & V;
@@ -84,7 +100,24 @@ public:
 	vector < coordinates > C;
 	vector < vector < unsigned int > > Kvec;
 
-	//random states
+	//Conditioning haplotypes of the current window [reused across windows]
+	bitmatrix Hvar;
+
+	//HMM forward/backward arrays of the current window [reused across windows]
+	workspace_arena Work;
+
+	//Time spent in window setup and HMM computations, and overall time spent phasing samples [seconds]
+	double time_setup, time_hmm, time_busy;
+
+	//HMM cost trace [flushed when full and at the end of each iteration]
+	vector < trace_event > Trace;
+
+	//Hardware counters of the worker thread over the current HMM pass [--perf-counters]
+	perf_counters PMU;
+	vector < long > pmu_counts;
+
+	//random states [R is set to the stream of the current (iteration, individual) job]
+	counter_rng R;
 	vector < unsigned int > O;
 	int Oiter;
 
@@ -100,6 +133,8 @@ public:
 	void free();
 //	void reset();
 	void make(unsigned int, double);
+	void startCounters();
+	void stopCounters();
 	unsigned int size();
 	void maskingTransitions(unsigned int, double);
 	bool reccursive_window_splitting(double, int, int, vector < int > &, vector < int > &, vector < double > &, vector < double > &, vector < int > &);
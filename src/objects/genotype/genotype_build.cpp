@@ -40,118 +40,115 @@
 
 #include <objects/genotype/genotype_header.h>
 
-void genotype::build() {
-	//1. Count number of segments
-	//unsigned n_unf = 0, n_var = 0, n_sca = 0, n_seg = 0, n_amb = 0;
-	double_precision = false;
-	unsigned n_rel_unf = 0, n_rel_var = 0, n_rel_sca = 0, n_abs_seg = 0, n_abs_amb = 0, n_rel_amb = 0, n_abs_mis = 0;
-	for (unsigned int v = 0 ; v < n_variants ;) {
-		bool f_sca = VAR_GET_SCA(MOD2(v),Variants[DIV2(v)]);
-		bool f_het = VAR_GET_HET(MOD2(v),Variants[DIV2(v)]);
-		bool f_mis = VAR_GET_MIS(MOD2(v),Variants[DIV2(v)]);
-		double_precision = double_precision || f_sca;
-		//unsigned int predicted_unfold = n_rel_unf + f_het + (n_rel_sca||f_sca);
-		unsigned int predicted_unfold = n_rel_unf + f_het + (n_rel_sca||f_sca);
-		if (predicted_unfold == 4 || (n_rel_var == std::numeric_limits< unsigned short >::max()) || (n_rel_amb == MAX_AMB)) {
-			n_rel_unf = 0;
-			n_rel_sca = 0;
-			n_rel_var = 0;
-			n_rel_amb = 0;
-			n_abs_seg ++;
-		} else {
-			n_rel_unf += f_het;
-			n_rel_sca += f_sca;
-			n_abs_amb += (f_het||f_sca);
-			n_rel_amb += (f_het||f_sca);
-			n_abs_mis += f_mis;
-			n_rel_var ++;
-			v++;
-		}
-	}
-	n_segments = n_abs_seg + 1;
-	n_ambiguous = n_abs_amb;
-	n_missing = n_abs_mis;
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
-	//2. Build Segments
-	n_rel_unf = 0; n_rel_var = 0; n_rel_sca = 0; n_abs_seg = 0; n_abs_amb = 0; n_rel_amb = 0; n_abs_mis = 0;
-	Lengths = vector < unsigned short > (n_segments, 0U);
-	for (unsigned int v = 0 ; v < n_variants ;) {
-		bool f_sca = VAR_GET_SCA(MOD2(v),Variants[DIV2(v)]);
-		bool f_het = VAR_GET_HET(MOD2(v),Variants[DIV2(v)]);
-		bool f_mis = VAR_GET_MIS(MOD2(v),Variants[DIV2(v)]);
+//Interleaves the bits of a 32-bit mask with zeros [bit i goes to bit 2i]
+inline
+unsigned long spreadBits(unsigned int x) {
+	unsigned long v = x;
+	v = (v | (v << 16)) & 0x0000FFFF0000FFFFUL;
+	v = (v | (v << 8)) & 0x00FF00FF00FF00FFUL;
+	v = (v | (v << 4)) & 0x0F0F0F0F0F0F0F0FUL;
+	v = (v | (v << 2)) & 0x3333333333333333UL;
+	v = (v | (v << 1)) & 0x5555555555555555UL;
+	return v;
+}
 
-		unsigned int predicted_unfold = n_rel_unf + f_het + (n_rel_sca||f_sca);
-		if (predicted_unfold == 4 || (n_rel_var == std::numeric_limits< unsigned short >::max()) || (n_rel_amb == MAX_AMB)) {
-			Lengths[n_abs_seg] = n_rel_var;
-			n_rel_unf = 0;
-			n_rel_sca = 0;
-			n_rel_var = 0;
-			n_rel_amb = 0;
-			n_abs_seg ++;
-		} else {
-			n_rel_unf += f_het;
-			n_rel_sca += f_sca;
-			n_abs_amb += (f_het||f_sca);
-			n_rel_amb += (f_het||f_sca);
-			n_abs_mis += f_mis;
-			n_rel_var ++;
-			v++;
-		}
+//Classifies the variants of a Variants array into het and scaffold bitmasks [64 variants per word] and returns the number of missing genotypes
+unsigned int classifyVariants(const unsigned char * var, unsigned int n_variants, vector < unsigned long > & maskHet, vector < unsigned long > & maskSca) {
+	unsigned int n_words = (n_variants + 63) / 64, n_mis = 0, w = 0;
+	maskHet.assign(n_words, 0UL);
+	maskSca.assign(n_words, 0UL);
+#ifdef __AVX2__
+	//32 bytes [64 variants] at a time: low nibbles hold even variants, high nibbles odd ones
+	const __m256i _three = _mm256_set1_epi8(3), _one = _mm256_set1_epi8(1), _two = _mm256_set1_epi8(2);
+	for (; (w + 1) * 64 <= n_variants ; w ++) {
+		__m256i _x = _mm256_loadu_si256((const __m256i *)(var + w * 32));
+		__m256i _lo = _mm256_and_si256(_x, _three);
+		__m256i _hi = _mm256_and_si256(_mm256_srli_epi16(_x, 4), _three);
+		maskHet[w] = spreadBits(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_lo, _two))) | (spreadBits(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_hi, _two))) << 1);
+		maskSca[w] = spreadBits(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_lo, _three))) | (spreadBits(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_hi, _three))) << 1);
+		n_mis += __builtin_popcount(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_lo, _one))) + __builtin_popcount(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_hi, _one)));
+	}
+#endif
+	for (unsigned int v = w * 64 ; v < n_variants ; v ++) {
+		if (VAR_GET_HET(MOD2(v), var[DIV2(v)])) maskHet[v >> 6] |= 1UL << (v & 63);
+		if (VAR_GET_SCA(MOD2(v), var[DIV2(v)])) maskSca[v >> 6] |= 1UL << (v & 63);
+		n_mis += VAR_GET_MIS(MOD2(v), var[DIV2(v)]);
 	}
-	Lengths[n_abs_seg] = n_rel_var;
+	return n_mis;
+}
 
-	//3. Build Ambiguous
-	Ambiguous = vector < unsigned char >(n_ambiguous, 0U);
-	vector < unsigned char > orderedSegments = vector < unsigned char >(n_segments, 0);
-	for (unsigned int s = 0, a0 = 0, a1 = 0, a2 = 0, vabs = 0 ; s < n_segments ; s ++) {
-		for (unsigned int vrel = 0 ; vrel < Lengths[s] ; vrel ++) {
-			bool f_sca = VAR_GET_SCA(MOD2(vabs+vrel),Variants[DIV2(vabs+vrel)]);
-			bool f_het = VAR_GET_HET(MOD2(vabs+vrel),Variants[DIV2(vabs+vrel)]);
-			if (f_sca) {
-				for (unsigned int h = 0 ; h < HAP_NUMBER ; h ++) {
-					bool allele = (h%2)?VAR_GET_HAP1(MOD2(vabs+vrel), Variants[DIV2(vabs+vrel)]):VAR_GET_HAP0(MOD2(vabs+vrel), Variants[DIV2(vabs+vrel)]);
-					if (allele) HAP_SET(Ambiguous[a0], h);
-				}
-				orderedSegments[s] = 1;
-			}
-			a0 += (f_sca||f_het);
-		}
-		unsigned int n_unf = orderedSegments[s];
-		for (unsigned int vrel = 0 ; vrel < Lengths[s] ; vrel ++) {
-			bool f_sca = VAR_GET_SCA(MOD2(vabs+vrel),Variants[DIV2(vabs+vrel)]);
-			bool f_het = VAR_GET_HET(MOD2(vabs+vrel),Variants[DIV2(vabs+vrel)]);
-			if (f_het) {
-				for (unsigned int h = 0 ; h < HAP_NUMBER ; h ++) {
-					bool allele = ((h>>n_unf)%2);
-					if (allele) HAP_SET(Ambiguous[a1], h);
+void genotype::build() {
+	vector < unsigned long > maskHet, maskSca;
+	n_missing = classifyVariants(Variants.data(), n_variants, maskHet, maskSca);
+
+	vector < unsigned short > segLengths;
+	vector < unsigned char > segAmbiguous;
+	vector < unsigned long > segDiplotypes;
+	segAmbiguous.reserve(n_variants / 8);
+
+	//Walk over ambiguous variants only: homozygous and missing genotypes never trigger an unfolding break
+	unsigned int n_rel_unf = 0, n_rel_sca = 0, n_rel_var = 0, n_rel_amb = 0, v = 0;
+	unsigned char amb_sca[MAX_AMB], amb_hap[MAX_AMB];
+	double_precision = false;
+	for (;;) {
+		bool close = (v == n_variants);
+		if (!close && n_rel_var < std::numeric_limits< unsigned short >::max() && n_rel_amb < MAX_AMB) {
+			//Jump to next ambiguous variant, or as far as the segment length allows
+			unsigned int w = v >> 6, next = n_variants;
+			unsigned long bits = (maskHet[w] | maskSca[w]) & (~0UL << (v & 63));
+			while (!bits && ++w < maskHet.size()) bits = maskHet[w] | maskSca[w];
+			if (bits) next = min(n_variants, (w << 6) + __builtin_ctzl(bits));
+			unsigned int step = min(next - v, std::numeric_limits< unsigned short >::max() - n_rel_var);
+			n_rel_var += step;
+			v += step;
+			if (v == next && v < n_variants && n_rel_var == std::numeric_limits< unsigned short >::max()) close = true;
+			else if (v == next && v < n_variants) {
+				bool f_het = (maskHet[v >> 6] >> (v & 63)) & 1UL;
+				bool f_sca = !f_het;
+				if (n_rel_unf + f_het + (n_rel_sca||f_sca) == 4) close = true;
+				else {
+					amb_sca[n_rel_amb] = f_sca;
+					amb_hap[n_rel_amb] = (VAR_GET_HAP0(MOD2(v), Variants[DIV2(v)])?0x55:0) | (VAR_GET_HAP1(MOD2(v), Variants[DIV2(v)])?0xAA:0);
+					n_rel_unf += f_het;
+					n_rel_sca += f_sca;
+					n_rel_amb ++;
+					n_rel_var ++;
+					v ++;
 				}
-				n_unf++;
-			}
-			a1 += (f_sca||f_het);
+			} else if (v == n_variants) close = true;
+			if (!close) continue;
 		}
-		vabs += Lengths[s];
-	}
 
-	//4. Build Diplotypes
-	Diplotypes = vector < unsigned long > (n_segments);
-	for (unsigned int s = 0, vabs = 0, a = 0 ; s < n_segments ; s ++) {
-		unsigned int n_unf = orderedSegments[s];
-		Diplotypes[s]=n_unf?MASK_SCAF:MASK_INIT;
-		for (unsigned int vrel = 0 ; vrel < Lengths[s] ; vrel ++) {
-			bool f_het = VAR_GET_HET(MOD2(vabs+vrel),Variants[DIV2(vabs+vrel)]);
-			if (f_het) {
+		//Close current segment: fill its Ambiguous bytes and Diplotypes mask
+		unsigned int n_unf = (n_rel_sca > 0);
+		unsigned long dip = n_unf?MASK_SCAF:MASK_INIT;
+		for (unsigned int a = 0 ; a < n_rel_amb ; a ++) {
+			if (amb_sca[a]) segAmbiguous.push_back(amb_hap[a]);
+			else {
 				switch (n_unf) {
-				case 0: Diplotypes[s] &= MASK_UNF0; break;
-				case 1: Diplotypes[s] &= MASK_UNF1; break;
-				case 2: Diplotypes[s] &= MASK_UNF2; break;
+				case 0: segAmbiguous.push_back(0xAA); dip &= MASK_UNF0; break;
+				case 1: segAmbiguous.push_back(0xCC); dip &= MASK_UNF1; break;
+				case 2: segAmbiguous.push_back(0xF0); dip &= MASK_UNF2; break;
 				}
+				n_unf ++;
 			}
-			n_unf += f_het;
 		}
-		for (unsigned int vrel = 0 ; vrel < Lengths[s] ; vrel ++) a+=VAR_GET_AMB(MOD2(vabs+vrel),Variants[DIV2(vabs+vrel)]);
-		vabs += Lengths[s];
+		double_precision = double_precision || (n_rel_sca > 0);
+		segLengths.push_back(n_rel_var);
+		segDiplotypes.push_back(dip);
+		if (v == n_variants) break;
+		n_rel_unf = n_rel_sca = n_rel_var = n_rel_amb = 0;
 	}
+	n_segments = segLengths.size();
+	n_ambiguous = segAmbiguous.size();
+	Lengths = segLengths;
+	Ambiguous = segAmbiguous;
+	Diplotypes = segDiplotypes;
 
-	//5. Count transitions
+	//Count transitions
 	n_transitions = countTransitions();
 }
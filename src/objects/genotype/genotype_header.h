@@ -55,6 +55,11 @@
 
 #define PS_ALLOC_CHUNK	32
 
+//Quantized storage of accumulated phase probabilities, normalised by the number of storage events
+//Transitions are stored on a log scale down to PROB_QUANT_MIN, missing allele probabilities on a linear scale
+#define PROB_QUANT_MIN		1e-6
+#define PROB_QUANT_LOGMIN	13.815510557964274	//-log(PROB_QUANT_MIN)
+
 struct phase_set {
 	unsigned int ps : 30;
 	unsigned int a0 : 1;
@@ -79,46 +84,92 @@ public:
 	unsigned int n_stored_transitionProbs;	// Number of transition probabilities stored in memory
 	unsigned int n_storage_events;			// Number of storage having been done
 	bool double_precision;					// Are HMM computation done with double or single floating point precision?
+	unsigned char prob_bits;				// Precision of ProbStored and ProbMissing [32: float, 16 or 8: quantized in ProbQuantized]
 	unsigned char curr_dipcodes [64];		// List of diplotypes in a given segment (buffer style variable)
 
-	// VARIANT / HAPLOTYPE / DIPLOTYPE DATA
-	vector < unsigned char > Variants;		// 0.5 byte per variant
-	vector < unsigned char > Ambiguous;		// 1 byte per ambiguous variant
-	vector < unsigned long > Diplotypes;	// 8 bytes per segment
-	vector < unsigned short > Lengths;		// 2 bytes per segment
+	// VARIANT / HAPLOTYPE / DIPLOTYPE DATA [views into the arenas of genotype_set once compacted]
+	buffer_view < unsigned char > Variants;		// 0.5 byte per variant
+	buffer_view < unsigned char > Ambiguous;	// 1 byte per ambiguous variant
+	buffer_view < unsigned long > Diplotypes;	// 8 bytes per segment
+	buffer_view < unsigned short > Lengths;		// 2 bytes per segment
 
 	//PHASE PROBS
-	vector < bool > ProbMask;
-	vector < float > ProbStored;
-	vector < float > ProbMissing;
+	bit_vector ProbMask;						// Transitions with a stored probability [rank gives the index in ProbStored]
+	buffer_view < float > ProbStored;
+	buffer_view < float > ProbMissing;
+	buffer_view < unsigned char > ProbQuantized;	// Quantized ProbStored followed by quantized ProbMissing [prob_bits/8 bytes each]
 
 	// PHASE SETS
 	vector < phase_set > PhaseSets;			// Phase set memberships for the ambiguous genotypes (hets, missing, scaffold, etc ...)
-	vector < bool > ProbabilityMask;		// Flag non-zero transition probabilities derived from VCF phase sets
+	bit_vector ProbabilityMask;				// Flag non-zero transition probabilities derived from VCF phase sets
 
 	//METHODS
 	genotype(unsigned int);
 	~genotype();
 	void free();
-	void make(vector < unsigned char > &, vector < float > &);
+	void make(vector < unsigned char > &, vector < float > &, counter_rng &);
 	void make(vector < unsigned char > &);
 	void build();
-	void sample(vector < double > &, vector < float > &);
-	void sampleForward(vector < double > &, vector < float > &);
-	void sampleBackward(vector < double > &, vector < float > &);
-	void solve();
+	void sample(vector < double > &, vector < float > &, counter_rng &);
+	void sampleForward(vector < double > &, vector < float > &, counter_rng &);
+	void sampleBackward(vector < double > &, vector < float > &, counter_rng &);
+	void solve(vector < unsigned char > &, vector < unsigned char > &);
 	void mapMerges(vector < double > &, double , vector < bool > &);
 	void performMerges(vector < double > &, vector < bool > &);
 	void mask();
-	void store(vector < double > &, vector < float > &);
+	double store(vector < double > &, vector < float > &);
+	void quantize(unsigned int, unsigned char *, double &, double &);
 
 	//INLINES
 	unsigned int countDiplotypes(unsigned long);
 	void makeDiplotypes(unsigned long);
+	unsigned char getDiplotype(unsigned long, unsigned int);
 	unsigned int countTransitions();
 	void pushPS(bool _a0, bool _a1, int ps);
+	float getProbStored(unsigned int);
+	float getProbMissing(unsigned int);
 };
 
+inline
+unsigned int quantizeTransition(double prob, unsigned int n_events, unsigned int qmax) {
+	double p = prob / max(n_events, 1U);
+	if (p <= PROB_QUANT_MIN) return qmax;
+	return min((unsigned int)round(-log(p) * qmax / PROB_QUANT_LOGMIN), qmax);
+}
+
+inline
+float dequantizeTransition(unsigned int q, unsigned int n_events, unsigned int qmax) {
+	return max(n_events, 1U) * exp(-(q * PROB_QUANT_LOGMIN / qmax));
+}
+
+inline
+unsigned int quantizeMissing(double prob, unsigned int n_events, unsigned int qmax) {
+	return (unsigned int)round(min(max(prob / max(n_events, 1U), 0.0), 1.0) * qmax);
+}
+
+inline
+float dequantizeMissing(unsigned int q, unsigned int n_events, unsigned int qmax) {
+	return q * max(n_events, 1U) * 1.0 / qmax;
+}
+
+inline
+float genotype::getProbStored(unsigned int i) {
+	switch (prob_bits) {
+	case 8:		return dequantizeTransition(ProbQuantized[i], n_storage_events, 0xFF);
+	case 16:	return dequantizeTransition(reinterpret_cast < unsigned short * > (ProbQuantized.data())[i], n_storage_events, 0xFFFF);
+	default:	return ProbStored[i];
+	}
+}
+
+inline
+float genotype::getProbMissing(unsigned int i) {
+	switch (prob_bits) {
+	case 8:		return dequantizeMissing(ProbQuantized[n_stored_transitionProbs + i], n_storage_events, 0xFF);
+	case 16:	return dequantizeMissing(reinterpret_cast < unsigned short * > (ProbQuantized.data())[n_stored_transitionProbs + i], n_storage_events, 0xFFFF);
+	default:	return ProbMissing[i];
+	}
+}
+
 inline
 void genotype::pushPS(bool _a0, bool _a1, int _ps) {
 	if (PhaseSets.size() == PhaseSets.capacity()) PhaseSets.reserve(PhaseSets.capacity() + PS_ALLOC_CHUNK);
@@ -137,6 +188,13 @@ void genotype::makeDiplotypes(unsigned long _dip) {
 	for (unsigned int d = 0, i = 0 ; d < 64 ; ++d) if (DIP_GET(_dip, d)) curr_dipcodes[i++] = d;
 }
 
+//Code of the i-th diplotype set in _dip [avoids rebuilding curr_dipcodes when a single one is needed]
+inline
+unsigned char genotype::getDiplotype(unsigned long _dip, unsigned int i) {
+	for (; i ; i --) _dip &= _dip - 1;
+	return __builtin_ctzl(_dip);
+}
+
 inline
 unsigned int genotype::countTransitions() {
 	unsigned int prev_dipcount = 1, c = 0;
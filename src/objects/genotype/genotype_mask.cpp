@@ -31,7 +31,7 @@ void genotype::mask() {
 	}
 	if (toBeProcessed) {
 		// Allocate ProbabilityMask
-		ProbabilityMask = vector < bool > (n_transitions, true);
+		ProbabilityMask.allocate(n_transitions, true);
 		// Iterates over segments
 		unsigned char prev_dipcodes [64];
 		unsigned int prev_dipcount = 1, curr_dipcount = 0, n_curr_trans = 0, n_curr_amb = 0;
@@ -92,7 +92,7 @@ void genotype::mask() {
 						for (unsigned int l = 0 ; l < n_curr_amb ; l ++) {
 							if (it->second[2*l] >= 0) {
 								if (first_allele < 0) first_allele = (haplotype[l] != it->second[2*l]);
-								else if (haplotype[l] != it->second[2*l+first_allele]) ProbabilityMask[t+trel] = false;
+								else if (haplotype[l] != it->second[2*l+first_allele]) ProbabilityMask.unset(t+trel);
 							}
 						}
 					}
@@ -166,7 +166,7 @@ void genotype::mask() {
 						for (unsigned int l = 0 ; l < n_curr_amb ; l ++) {
 							if (it->second[2*l] >= 0) {
 								if (first_allele < 0) first_allele = (haplotype[l] != it->second[2*l]);
-								else if (haplotype[l] != it->second[2*l+first_allele]) ProbabilityMask[t+trel] = false;
+								else if (haplotype[l] != it->second[2*l+first_allele]) ProbabilityMask.unset(t+trel);
 							}
 						}
 					}
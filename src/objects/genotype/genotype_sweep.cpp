@@ -21,37 +21,39 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include <objects/genotype/genotype_header.h>
 
-void genotype::sample(vector < double > & CurrentTransProbabilities, vector < float > & CurrentMissingProbabilities) {
-	if (rng.getDouble() < 0.5f) sampleForward(CurrentTransProbabilities, CurrentMissingProbabilities);
-	else sampleBackward(CurrentTransProbabilities, CurrentMissingProbabilities);
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+void genotype::sample(vector < double > & CurrentTransProbabilities, vector < float > & CurrentMissingProbabilities, counter_rng & R) {
+	if (R.getDouble() < 0.5f) sampleForward(CurrentTransProbabilities, CurrentMissingProbabilities, R);
+	else sampleBackward(CurrentTransProbabilities, CurrentMissingProbabilities, R);
 }
 
-void genotype::sampleForward(vector < double > & CurrentTransProbabilities, vector < float > & CurrentMissingProbabilities) {
+void genotype::sampleForward(vector < double > & CurrentTransProbabilities, vector < float > & CurrentMissingProbabilities, counter_rng & R) {
 	double sumProbs = 0.0;
 	unsigned int prev_sampled = 0;
 	unsigned int curr_dipcount = 0, prev_dipcount = 1;
-	vector < double > currProbs = vector < double > (64, 0.0);
 	vector < unsigned char > DipSampled = vector < unsigned char >(n_segments, 0);
 	for (unsigned int s = 0, toffset = 0 ; s < n_segments ; s ++) {
 		sumProbs = 0.0;
 		curr_dipcount = countDiplotypes(Diplotypes[s]);
-		for (unsigned int tabs = toffset + prev_sampled*curr_dipcount, trel = 0 ; trel < curr_dipcount ; ++trel, ++tabs)
-			sumProbs += (currProbs[trel] = CurrentTransProbabilities[tabs]);
-		prev_sampled = rng.sample(currProbs, sumProbs);
-		makeDiplotypes(Diplotypes[s]);
-		DipSampled[s] = curr_dipcodes[prev_sampled];
+		const double * currProbs = &CurrentTransProbabilities[toffset + prev_sampled*curr_dipcount];
+		for (unsigned int trel = 0 ; trel < curr_dipcount ; ++trel) sumProbs += currProbs[trel];
+		prev_sampled = R.sample(currProbs, curr_dipcount, sumProbs);
+		DipSampled[s] = getDiplotype(Diplotypes[s], prev_sampled);
 		toffset += prev_dipcount * curr_dipcount;
 		prev_dipcount = curr_dipcount;
 	}
-	make(DipSampled, CurrentMissingProbabilities);
+	make(DipSampled, CurrentMissingProbabilities, R);
 }
 
-void genotype::sampleBackward(vector < double > & CurrentTransProbabilities, vector < float > & CurrentMissingProbabilities) {
+void genotype::sampleBackward(vector < double > & CurrentTransProbabilities, vector < float > & CurrentMissingProbabilities, counter_rng & R) {
 
 	double sumProbs = 0.0;
 	int next_sampled = -1;
 	unsigned int curr_dipcount = 0, next_dipcount = countDiplotypes(Diplotypes[n_segments - 1]);
-	vector < double > currProbs = vector < double > (64 * 64, 0.0);
+	double currProbs [64];
 	vector < unsigned char > DipSampled = vector < unsigned char >(n_segments, 0);
 
 	for (int s = n_segments - 2, toffset = n_transitions ; s >= 0 ; s --) {
@@ -60,80 +62,129 @@ void genotype::sampleBackward(vector < double > & CurrentTransProbabilities, vec
 		toffset -= next_dipcount * curr_dipcount;
 
 		if (next_sampled >= 0) {
-			currProbs.resize(64);
 			for (unsigned int tabs = toffset+next_sampled, trel = 0 ; trel < curr_dipcount ; ++trel, tabs += next_dipcount)
 				sumProbs += (currProbs[trel] = CurrentTransProbabilities[tabs]);
-			next_sampled = rng.sample(currProbs, sumProbs);
-			makeDiplotypes(Diplotypes[s]);
-			DipSampled[s] = curr_dipcodes[next_sampled];
+			next_sampled = R.sample(currProbs, curr_dipcount, sumProbs);
+			DipSampled[s] = getDiplotype(Diplotypes[s], next_sampled);
 		} else {
-			for (unsigned int tabs = toffset, trel = 0 ; tabs < n_transitions ; ++trel, ++tabs)
-				sumProbs += (currProbs[trel] = CurrentTransProbabilities[tabs]);
-			next_sampled = rng.sample(currProbs, sumProbs);
-			makeDiplotypes(Diplotypes[s+1]);
-			DipSampled[s+1] = curr_dipcodes[next_sampled % next_dipcount];
-			makeDiplotypes(Diplotypes[s]);
+			for (unsigned int tabs = toffset ; tabs < n_transitions ; ++tabs) sumProbs += CurrentTransProbabilities[tabs];
+			next_sampled = R.sample(&CurrentTransProbabilities[toffset], n_transitions - toffset, sumProbs);
+			DipSampled[s+1] = getDiplotype(Diplotypes[s+1], next_sampled % next_dipcount);
 			next_sampled = next_sampled / next_dipcount;
-			DipSampled[s] = curr_dipcodes[next_sampled];
+			DipSampled[s] = getDiplotype(Diplotypes[s], next_sampled);
 		}
 		next_dipcount = curr_dipcount;
 	}
-	make(DipSampled, CurrentMissingProbabilities);
+	make(DipSampled, CurrentMissingProbabilities, R);
 }
 
-void genotype::solve() {
+//Max-product (Viterbi) pass over the genotype graph. Backtrack [n_segments x 64] and DipSampled [n_segments] are caller-owned buffers reused across samples
+void genotype::solve(vector < unsigned char > & Backtrack, vector < unsigned char > & DipSampled) {
 	unsigned int curr_dipcount = 0, prev_dipcount = 1;
-	vector < vector < double > > maxProbs = vector < vector < double > > (n_segments, vector < double > ());
-	vector < vector < int > > maxIndexes = vector < vector < int > > (n_segments, vector < int > ());
+#ifdef __AVX2__
+	double maxProbs [2][64] __attribute__ ((aligned(32)));
+	double maxIndexes [64] __attribute__ ((aligned(32)));
+	double transProbs [64] __attribute__ ((aligned(32)));
+#else
+	double maxProbs [2][64];
+	double maxIndexes [64];
+	double transProbs [64];
+#endif
+	if (Backtrack.size() < n_segments * 64) Backtrack.resize(n_segments * 64);
+	if (DipSampled.size() < n_segments) DipSampled.resize(n_segments);
+	maxProbs[1][0] = 1.0;
 
-	for (int s = 0, toffset = 0, trel = 0 ; s < n_segments ; s ++) {
+	for (unsigned int s = 0, toffset = 0, trel = 0 ; s < n_segments ; s ++) {
+		double * prevMax = maxProbs[(s + 1) % 2];
+		double * currMax = maxProbs[s % 2];
 		curr_dipcount = countDiplotypes(Diplotypes[s]);
-		maxProbs[s] = vector < double > (curr_dipcount, 0.0);
-		maxIndexes[s] = vector < int > (curr_dipcount, 0);
-		for (int t = 0 ; t < prev_dipcount * curr_dipcount ; t++) {
-			int prev_dip = t/curr_dipcount;
-			int next_dip = t%curr_dipcount;
-			//double currProb = (s?maxProbs[s-1][prev_dip]:1.0) * StoredProbs[t+toffset];
-			double currProb = (s?maxProbs[s-1][prev_dip]:1.0) * (ProbMask[t+toffset]?ProbStored[trel++]:1e-6);
-			if (currProb > maxProbs[s][next_dip]) {
-				maxProbs[s][next_dip] = currProb;
-				maxIndexes[s][next_dip] = prev_dip;
+		unsigned int curr_dippadded = (curr_dipcount + 3) & ~3U;
+		for (unsigned int d = 0 ; d < curr_dippadded ; d ++) currMax[d] = maxIndexes[d] = transProbs[d] = 0.0;
+		for (unsigned int prev_dip = 0 ; prev_dip < prev_dipcount ; prev_dip ++, toffset += curr_dipcount) {
+			//Expand the row of stored transition probabilities leaving prev_dip
+			for (unsigned int next_dip = 0 ; next_dip < curr_dipcount ; next_dip ++)
+				transProbs[next_dip] = ProbMask.get(toffset + next_dip)?getProbStored(trel++):1e-6;
+#ifdef __AVX2__
+			__m256d _prev = _mm256_set1_pd(prevMax[prev_dip]);
+			__m256d _pidx = _mm256_set1_pd(prev_dip);
+			for (unsigned int d = 0 ; d < curr_dippadded ; d += 4) {
+				__m256d _cand = _mm256_mul_pd(_prev, _mm256_load_pd(&transProbs[d]));
+				__m256d _curr = _mm256_load_pd(&currMax[d]);
+				__m256d _gt = _mm256_cmp_pd(_cand, _curr, _CMP_GT_OQ);
+				_mm256_store_pd(&currMax[d], _mm256_blendv_pd(_curr, _cand, _gt));
+				_mm256_store_pd(&maxIndexes[d], _mm256_blendv_pd(_mm256_load_pd(&maxIndexes[d]), _pidx, _gt));
+			}
+#else
+			for (unsigned int d = 0 ; d < curr_dipcount ; d ++) {
+				double currProb = prevMax[prev_dip] * transProbs[d];
+				if (currProb > currMax[d]) {
+					currMax[d] = currProb;
+					maxIndexes[d] = prev_dip;
+				}
 			}
+#endif
 		}
 		double sumProb = 0.0;
-		for (int d = 0 ; d < curr_dipcount ; d ++) sumProb += maxProbs[s][d];
-		for (int d = 0 ; d < curr_dipcount ; d ++) maxProbs[s][d] /= sumProb;
-		toffset += prev_dipcount * curr_dipcount;
+		for (unsigned int d = 0 ; d < curr_dipcount ; d ++) sumProb += currMax[d];
+		for (unsigned int d = 0 ; d < curr_dipcount ; d ++) {
+			currMax[d] /= sumProb;
+			Backtrack[s * 64 + d] = (unsigned char)maxIndexes[d];
+		}
 		prev_dipcount = curr_dipcount;
 	}
 
-	vector < unsigned char > DipSampled = vector < unsigned char >(n_segments, 0);
-	unsigned int bestDip = alg.imax(maxProbs.back());
-	makeDiplotypes(Diplotypes.back());
-	DipSampled.back() = curr_dipcodes[bestDip];
-	for (int s = DipSampled.size() - 2 ; s >= 0 ; s --) {
-		bestDip = maxIndexes[s+1][bestDip];
-		makeDiplotypes(Diplotypes[s]);
-		DipSampled[s] = curr_dipcodes[bestDip];
+	const double * lastMax = maxProbs[(n_segments - 1) % 2];
+	unsigned int bestDip = 0;
+	for (unsigned int d = 1 ; d < prev_dipcount ; d ++) if (lastMax[d] > lastMax[bestDip]) bestDip = d;
+	DipSampled[n_segments - 1] = getDiplotype(Diplotypes[n_segments - 1], bestDip);
+	for (int s = n_segments - 2 ; s >= 0 ; s --) {
+		bestDip = Backtrack[(s + 1) * 64 + bestDip];
+		DipSampled[s] = getDiplotype(Diplotypes[s], bestDip);
 	}
 	make(DipSampled);
 }
 
-void genotype::store(vector < double > & CurrentTransProbabilities, vector < float > & CurrentMissingProbabilities) {
+//Returns the mean absolute change of the averaged transition probabilities brought by this storage event
+double genotype::store(vector < double > & CurrentTransProbabilities, vector < float > & CurrentMissingProbabilities) {
 	if (ProbMask.size() == 0) {
-		n_stored_transitionProbs = 0;
-		ProbMask = vector < bool > (n_transitions, false);
-		for (unsigned int t = 0 ; t < n_transitions ; t ++) if (CurrentTransProbabilities[t] >= 1e-6) {
-			n_stored_transitionProbs ++;
-			ProbMask[t] = true;
-		}
-		ProbStored = vector  < float > (n_stored_transitionProbs, 0.0);
-		ProbMissing = vector < float > (n_missing * HAP_NUMBER, 0.0);
+		ProbMask.allocate(n_transitions, false);
+		for (unsigned int t = 0 ; t < n_transitions ; t ++) if (CurrentTransProbabilities[t] >= 1e-6) ProbMask.set(t);
+		n_stored_transitionProbs = ProbMask.buildRank();
+		ProbStored.allocate(n_stored_transitionProbs, 0.0f);
+		ProbMissing.allocate(n_missing * HAP_NUMBER, 0.0f);
 	}
-	for (unsigned int t = 0, trel = 0 ; t < n_transitions ; t ++) {
-		if (ProbMask[t]) ProbStored[trel++] += CurrentTransProbabilities[t];
-		//if (!ProbMask[t] && CurrentTransProbabilities[t] > 0.01) cout << "Should be stored " << CurrentTransProbabilities[t] << endl;
+	double delta = 0.0;
+	for (unsigned int w = 0 ; w < ProbMask.sizeWords() ; w ++) {
+		unsigned long bits = ProbMask.word(w);
+		for (unsigned int trel = ProbMask.rankWord(w) ; bits ; bits &= bits - 1, trel ++) {
+			double p = CurrentTransProbabilities[(w << 6) + __builtin_ctzl(bits)];
+			if (n_storage_events) delta += fabs(p * n_storage_events - ProbStored[trel]);
+			ProbStored[trel] += p;
+		}
 	}
 	for (unsigned int m = 0 ; m < (n_missing * HAP_NUMBER) ; m ++) ProbMissing[m] += CurrentMissingProbabilities[m];
 	n_storage_events ++;
+	if (n_storage_events < 2 || n_stored_transitionProbs == 0) return 0.0;
+	return delta / ((double)n_storage_events * (n_storage_events - 1) * n_stored_transitionProbs);
+}
+
+void genotype::quantize(unsigned int bits, unsigned char * buffer, double & max_error_trans, double & max_error_miss) {
+	unsigned int qmax = (1U << bits) - 1, n_miss = n_missing * HAP_NUMBER;
+	unsigned short * buffer16 = reinterpret_cast < unsigned short * > (buffer);
+	for (unsigned int t = 0 ; t < n_stored_transitionProbs ; t ++) {
+		unsigned int q = quantizeTransition(ProbStored[t], n_storage_events, qmax);
+		if (bits == 8) buffer[t] = q;
+		else buffer16[t] = q;
+		if (ProbStored[t] > PROB_QUANT_MIN * n_storage_events) max_error_trans = max(max_error_trans, fabs(dequantizeTransition(q, n_storage_events, qmax) / ProbStored[t] - 1.0));
+	}
+	for (unsigned int m = 0 ; m < n_miss ; m ++) {
+		unsigned int q = quantizeMissing(ProbMissing[m], n_storage_events, qmax);
+		if (bits == 8) buffer[n_stored_transitionProbs + m] = q;
+		else buffer16[n_stored_transitionProbs + m] = q;
+		max_error_miss = max(max_error_miss, fabs(dequantizeMissing(q, n_storage_events, qmax) - ProbMissing[m]) * 1.0 / max(n_storage_events, 1U));
+	}
+	ProbQuantized.view(buffer, (n_stored_transitionProbs + n_miss) * (bits / 8));
+	ProbStored.clear();
+	ProbMissing.clear();
+	prob_bits = bits;
 }
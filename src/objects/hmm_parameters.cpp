@@ -44,6 +44,16 @@ void hmm_parameters::initialise(variant_map & V, int _Neff, int _Nhap) {
 		t[l-1] = -1.0f * expm1f(-0.04 * Neff * dist_cm / Nhap);
 		nt[l-1] = 1-t[l-1];
 	}
+	//Prefix tables for transitions between non adjacent loci [no expm1 in the HMM loops]
+	double rho = 0.04 * Neff / Nhap;
+	tmin = -1.0 * expm1(-rho * 1e-7);
+	lcum = vector < double > (V.size(), 0.0);
+	for (int l = 1 ; l < cm.size() ; l ++) lcum[l] = rho * (cm[l] - cm[0]);
+	ecum.clear();
+	if (lcum.back() < 600.0) {
+		ecum = vector < double > (V.size(), 1.0);
+		for (int l = 1 ; l < cm.size() ; l ++) ecum[l] = exp(-lcum[l]);
+	}
 	int count_rare = 0;
 	rare_allele = vector < char > (V.size(), -1);
 	for (int l = 0 ; l < V.size() ; l ++) if (V.vec_pos[l]->getMAF() <= RARE_VARIANT_FREQ) {
@@ -53,24 +63,4 @@ void hmm_parameters::initialise(variant_map & V, int _Neff, int _Nhap) {
 	vrb.bullet("HMM parameters [Ne=" + stb.str(Neff) + " / Error=" + stb.str(ed) + " / #rare=" + stb.str(count_rare) + "]");
 }
 
-float hmm_parameters::getForwardTransProb(int prev_idx, int curr_idx) {
-	assert(curr_idx>prev_idx);
-	if (curr_idx == (prev_idx + 1)) return t[prev_idx];
-	else {
-		float dist_cm = cm[curr_idx] - cm[prev_idx];
-		if (dist_cm <= 1e-7) dist_cm = 1e-7;
-		return -1.0f * expm1f(-0.04 * Neff * dist_cm / Nhap);
-	}
-}
-
-float hmm_parameters::getBackwardTransProb(int prev_idx, int curr_idx) {
-	assert(curr_idx<prev_idx);
-	if (curr_idx == (prev_idx - 1)) return t[curr_idx];
-	else {
-		float dist_cm = cm[prev_idx] - cm[curr_idx];
-		if (dist_cm <= 1e-7) dist_cm = 1e-7;
-		return -1.0f * expm1f(-0.04 * Neff * dist_cm / Nhap);
-	}
-}
-
 
@@ -35,6 +35,9 @@ public :
 	vector < float > nt;
 	vector < float > cm;
 	vector < char > rare_allele;
+	vector < double > lcum;		//Cumulative -log(1-t) from the first locus: no switch between two loci has probability exp(lcum[prev]-lcum[curr])
+	vector < double > ecum;		//exp(-lcum), so that any pair of loci needs a single division [empty when it would underflow]
+	double tmin;				//Transition probability for the minimal genetic distance
 	double ee;
 	double ed;
 
@@ -46,6 +49,27 @@ public :
 	void initialise(variant_map &, int, int);
 	float getForwardTransProb(int prev_idx, int curr_idx);
 	float getBackwardTransProb(int prev_idx, int curr_idx);
+	float getTransProb(int left_idx, int right_idx);
 };
 
+inline
+float hmm_parameters::getTransProb(int left_idx, int right_idx) {
+	double tprob = ecum.empty()?(-1.0f * expm1f(lcum[left_idx] - lcum[right_idx])):(1.0 - ecum[right_idx] / ecum[left_idx]);
+	return (tprob < tmin)?tmin:tprob;
+}
+
+inline
+float hmm_parameters::getForwardTransProb(int prev_idx, int curr_idx) {
+	assert(curr_idx>prev_idx);
+	if (curr_idx == (prev_idx + 1)) return t[prev_idx];
+	else return getTransProb(prev_idx, curr_idx);
+}
+
+inline
+float hmm_parameters::getBackwardTransProb(int prev_idx, int curr_idx) {
+	assert(curr_idx<prev_idx);
+	if (curr_idx == (prev_idx - 1)) return t[curr_idx];
+	else return getTransProb(curr_idx, prev_idx);
+}
+
 #endif
@@ -22,6 +22,7 @@
 #include <phaser/phaser_header.h>
 
 #include <io/haplotype_writer.h>
+#include <io/checkpoint_reader.h>
 
 void * phaseWindow_callback(void * ptr) {
 	phaser * S = static_cast< phaser * >( ptr );
@@ -29,17 +30,25 @@ void * phaseWindow_callback(void * ptr) {
 	pthread_mutex_lock(&S->mutex_workers);
 	id_worker = S->i_workers ++;
 	pthread_mutex_unlock(&S->mutex_workers);
+	if (S->perf.countersEnabled()) S->threadData[id_worker].startCounters();
 	for(;;) {
 		pthread_mutex_lock(&S->mutex_workers);
 		id_job = S->i_jobs ++;
 		if (id_job <= S->G.n_ind) vrb.progress("  * HMM computations", id_job*1.0/S->G.n_ind);
 		pthread_mutex_unlock(&S->mutex_workers);
-		if (id_job < S->G.n_ind) S->phaseWindow(id_worker, id_job);
-		else pthread_exit(NULL);
+		if (id_job < S->G.n_ind) {
+			if (!S->frozen[id_job]) S->phaseWindow(id_worker, id_job);
+		} else {
+			if (S->perf.countersEnabled()) S->threadData[id_worker].stopCounters();
+			pthread_exit(NULL);
+		}
 	}
 }
 
 void phaser::phaseWindow(int id_worker, int id_job) {
+	auto t_job = std::chrono::steady_clock::now();
+	//Random stream of this (iteration, individual) job: results do not depend on threads nor scheduling
+	threadData[id_worker].R.setStream(options["seed"].as < int > (), (current_iteration << 32) | id_job);
 	threadData[id_worker].make(id_job, options["window"].as < double > ());
 	for (int w = 0 ; w < threadData[id_worker].size() ; w ++) {
 		if (options["thread"].as < int > () > 1) pthread_mutex_lock(&mutex_workers);
@@ -52,14 +61,21 @@ void phaser::phaseWindow(int id_worker, int id_job) {
 		}
 
 		int outcome = 0;
+		auto t_start = std::chrono::steady_clock::now();
 		if (G.vecG[id_job]->double_precision) {
-			haplotype_segment_double HS(G.vecG[id_job], H.H_opt_hap, threadData[id_worker].Kvec[w], threadData[id_worker].C[w], M);
+			haplotype_segment_double HS(G.vecG[id_job], H.H_opt_hap, threadData[id_worker].Kvec[w], threadData[id_worker].C[w], M, threadData[id_worker].Hvar, threadData[id_worker].Work);
+			auto t_setup = std::chrono::steady_clock::now();
 			HS.forward();
 			outcome = HS.backward(threadData[id_worker].T, threadData[id_worker].M);
+			threadData[id_worker].time_setup += std::chrono::duration < double > (t_setup - t_start).count();
+			threadData[id_worker].time_hmm += std::chrono::duration < double > (std::chrono::steady_clock::now() - t_setup).count();
 		} else {
-			haplotype_segment_single HS(G.vecG[id_job], H.H_opt_hap, threadData[id_worker].Kvec[w], threadData[id_worker].C[w], M);
+			haplotype_segment_single HS(G.vecG[id_job], H.H_opt_hap, threadData[id_worker].Kvec[w], threadData[id_worker].C[w], M, threadData[id_worker].Hvar, threadData[id_worker].Work);
+			auto t_setup = std::chrono::steady_clock::now();
 			HS.forward();
 			outcome = HS.backward(threadData[id_worker].T, threadData[id_worker].M);
+			threadData[id_worker].time_setup += std::chrono::duration < double > (t_setup - t_start).count();
+			threadData[id_worker].time_hmm += std::chrono::duration < double > (std::chrono::steady_clock::now() - t_setup).count();
 		}
 
 		switch (outcome) {
@@ -79,16 +95,34 @@ void phaser::phaseWindow(int id_worker, int id_job) {
 
 	vector < bool > flagMerges;
 	switch (iteration_types[iteration_stage]) {
-	case STAGE_BURN:	G.vecG[id_job]->sample(threadData[id_worker].T, threadData[id_worker].M);
+	case STAGE_BURN:	G.vecG[id_job]->sample(threadData[id_worker].T, threadData[id_worker].M, threadData[id_worker].R);
 						break;
-	case STAGE_PRUN:	G.vecG[id_job]->sample(threadData[id_worker].T, threadData[id_worker].M);
+	case STAGE_PRUN:	G.vecG[id_job]->sample(threadData[id_worker].T, threadData[id_worker].M, threadData[id_worker].R);
 						G.vecG[id_job]->mapMerges(threadData[id_worker].T, options["mcmc-prune"].as < double > (), flagMerges);
 						G.vecG[id_job]->performMerges(threadData[id_worker].T, flagMerges);
 						break;
-	case STAGE_MAIN:	G.vecG[id_job]->sample(threadData[id_worker].T, threadData[id_worker].M);
-						G.vecG[id_job]->store(threadData[id_worker].T, threadData[id_worker].M);
+	case STAGE_MAIN:	G.vecG[id_job]->sample(threadData[id_worker].T, threadData[id_worker].M, threadData[id_worker].R);
+						store_changes[id_job] = G.vecG[id_job]->store(threadData[id_worker].T, threadData[id_worker].M);
 						break;
 	}
+	auto t_end = std::chrono::steady_clock::now();
+	threadData[id_worker].time_busy += std::chrono::duration < double > (t_end - t_job).count();
+
+	//Per-sample cost trace
+	if (trace.active()) {
+		trace_event e;
+		e.ind = id_job;
+		e.n_windows = threadData[id_worker].size();
+		e.n_cond = 0;
+		for (int w = 0 ; w < threadData[id_worker].size() ; w ++) e.n_cond += threadData[id_worker].Kvec[w].size();
+		e.n_transitions = G.vecG[id_job]->n_transitions;
+		e.n_missing = G.vecG[id_job]->n_missing;
+		e.double_precision = G.vecG[id_job]->double_precision;
+		e.start_ns = std::chrono::duration_cast < std::chrono::nanoseconds > (t_job - trace_origin).count();
+		e.elapsed_ns = std::chrono::duration_cast < std::chrono::nanoseconds > (t_end - t_job).count();
+		threadData[id_worker].Trace.push_back(e);
+		if (threadData[id_worker].Trace.size() >= TRACE_BUFFER_SIZE) trace.write(G, threadData[id_worker].Trace, id_worker);
+	}
 }
 
 void phaser::phaseWindow() {
@@ -98,40 +132,232 @@ void phaser::phaseWindow() {
 	i_workers = 0; i_jobs = 0;
 	statH.clear(); statS.clear();
 	storedKsizes.clear();
+	for (int t = 0 ; t < threadData.size() ; t++) {
+		threadData[t].time_setup = threadData[t].time_hmm = threadData[t].time_busy = 0.0;
+		threadData[t].Work.resetAllocated();
+	}
 	if (n_thread > 1) {
 		for (int t = 0 ; t < n_thread ; t++) pthread_create( &id_workers[t] , NULL, phaseWindow_callback, static_cast<void *>(this));
 		for (int t = 0 ; t < n_thread ; t++) pthread_join( id_workers[t] , NULL);
-	} else for (int i = 0 ; i < G.n_ind ; i ++) {
-		phaseWindow(0, i);
-		vrb.progress("  * HMM computations", (i+1)*1.0/G.n_ind);
+	} else {
+		if (perf.countersEnabled()) threadData[0].startCounters();
+		for (int i = 0 ; i < G.n_ind ; i ++) {
+			if (!frozen[i]) phaseWindow(0, i);
+			vrb.progress("  * HMM computations", (i+1)*1.0/G.n_ind);
+		}
+		if (perf.countersEnabled()) threadData[0].stopCounters();
+	}
+	double time_setup = 0.0, time_hmm = 0.0, work_alloc = 0.0, time_wall = tac.rel_time()*1.0/1000;
+	vector < double > time_busy;
+	vector < vector < long > > pmu_counts;
+	for (int t = 0 ; t < threadData.size() ; t++) { time_setup += threadData[t].time_setup; time_hmm += threadData[t].time_hmm; work_alloc += threadData[t].Work.allocated(); time_busy.push_back(threadData[t].time_busy); }
+	if (perf.countersEnabled()) for (int t = 0 ; t < threadData.size() ; t++) pmu_counts.push_back(threadData[t].pmu_counts);
+	perf.hmm(statH, statS, n_underflow_recovered, time_busy, pmu_counts, time_wall);
+	if (trace.active()) for (int t = 0 ; t < threadData.size() ; t++) trace.write(G, threadData[t].Trace, t);
+	if (n_underflow_recovered) vrb.bullet("HMM computations [K=" + stb.str(statH.mean(), 1) + "+/-" + stb.str(statH.sd(), 1) + " / W=" + stb.str(statS.mean(), 2) + "Mb / U=" + stb.str(n_underflow_recovered) + "] (" + stb.str(tac.rel_time()*1.0/1000, 2) + "s / setup=" + stb.str(time_setup, 2) + "s / hmm=" + stb.str(time_hmm, 2) + "s / alloc=" + stb.str(work_alloc / 1e6, 2) + "MB)");
+	else vrb.bullet("HMM computations [K=" + stb.str(statH.mean(), 3) + "+/-" + stb.str(statH.sd(), 3) + " / W=" + stb.str(statS.mean(), 2) + "Mb] (" + stb.str(tac.rel_time()*1.0/1000, 2) + "s / setup=" + stb.str(time_setup, 2) + "s / hmm=" + stb.str(time_hmm, 2) + "s / alloc=" + stb.str(work_alloc / 1e6, 2) + "MB)");
+}
+
+//Re-activates frozen individuals whose PBWT neighbourhood changed too much since freezing [or all of them]
+void phaser::reactivateFrozen(bool all) {
+	unsigned int n_frozen = 0, n_reactivated = 0;
+	unsigned long n_transitions = 0, n_transitions_frozen = 0;
+	vector < int > N;
+	for (int i = 0 ; i < G.n_ind ; i ++) {
+		if (frozen[i]) {
+			bool wake = all;
+			if (!wake) {
+				H.getPBWTneighbours(i, N);
+				unsigned long n_common = 0;
+				for (int a = 0, b = 0 ; a < N.size() && b < frozen_neighbours[i].size() ; ) {
+					if (N[a] < frozen_neighbours[i][b]) a ++;
+					else if (N[a] > frozen_neighbours[i][b]) b ++;
+					else { n_common ++; a ++; b ++; }
+				}
+				unsigned long n_union = N.size() + frozen_neighbours[i].size() - n_common;
+				wake = (n_union > 0 && (1.0 - n_common * 1.0 / n_union) > options["mcmc-freeze-pbwt"].as < double > ());
+			}
+			if (wake) {
+				frozen[i] = false;
+				stable_iterations[i] = 0;
+				vector < int > ().swap(frozen_neighbours[i]);
+				n_reactivated ++;
+			} else {
+				store_changes[i] = -1.0;
+				n_transitions_frozen += G.vecG[i]->n_transitions;
+				n_frozen ++;
+			}
+		}
+		n_transitions += G.vecG[i]->n_transitions;
+	}
+	vrb.bullet("Frozen individuals [n=" + stb.str(n_frozen) + " / reactivated=" + stb.str(n_reactivated) + "] / Skipped HMM work [" + stb.str(n_frozen * 100.0 / G.n_ind, 2) + "% individuals / " + stb.str(n_transitions_frozen * 100.0 / max(n_transitions, 1UL), 2) + "% transitions]");
+}
+
+//Freezes individuals whose haplotypes and graph did not change for --mcmc-freeze iterations
+void phaser::freezeConverged() {
+	for (int i = 0 ; i < G.n_ind ; i ++) {
+		if (frozen[i]) continue;
+		bool stable = (H.phase_changes[i] == 0 && G.vecG[i]->n_transitions == stable_transitions[i]);
+		stable_iterations[i] = stable?(stable_iterations[i] + 1):0;
+		stable_transitions[i] = G.vecG[i]->n_transitions;
+		if (stable_iterations[i] >= options["mcmc-freeze"].as < int > ()) {
+			frozen[i] = true;
+			H.getPBWTneighbours(i, frozen_neighbours[i]);
+		}
 	}
-	if (n_underflow_recovered) vrb.bullet("HMM computations [K=" + stb.str(statH.mean(), 1) + "+/-" + stb.str(statH.sd(), 1) + " / W=" + stb.str(statS.mean(), 2) + "Mb / U=" + stb.str(n_underflow_recovered) + "] (" + stb.str(tac.rel_time()*1.0/1000, 2) + "s)");
-	else vrb.bullet("HMM computations [K=" + stb.str(statH.mean(), 3) + "+/-" + stb.str(statH.sd(), 3) + " / W=" + stb.str(statS.mean(), 2) + "Mb] (" + stb.str(tac.rel_time()*1.0/1000, 2) + "s)");
+}
+
+void phaser::saveCheckpoint(unsigned int stage, unsigned int iter, unsigned long n_main_iterations, unsigned long n_old_segments, unsigned long n_prev_segments, bool skip_to_main) {
+	mcmc_state S;
+	S.scheme = options["mcmc-iterations"].as < string > ();
+	S.stage = stage;
+	S.iter = iter;
+	S.current_iteration = current_iteration;
+	S.n_main_iterations = n_main_iterations;
+	S.n_old_segments = n_old_segments;
+	S.n_prev_segments = n_prev_segments;
+	S.skip_to_main = skip_to_main;
+	S.iteration_done = iteration_done;
+	S.frozen = frozen;
+	S.stable_iterations = stable_iterations;
+	S.stable_transitions = stable_transitions;
+	S.frozen_neighbours = frozen_neighbours;
+	perf.begin("checkpoint");
+	checkpoint.write(G, H, S);
+	perf.end();
 }
 
 void phaser::phase() {
-	unsigned long n_old_segments = G.numberOfSegments(), n_new_segments = 0, current_iteration = 0;
-	for (iteration_stage = 0 ; iteration_stage < iteration_counts.size() ; iteration_stage ++) {
-		for (int iter = 0 ; iter < iteration_counts[iteration_stage] ; iter ++) {
+	unsigned long n_old_segments = G.numberOfSegments(), n_new_segments = 0, n_prev_segments = n_old_segments, n_main_iterations = 0;
+	bool adaptive = options.count("mcmc-adaptive"), freezing = options.count("mcmc-freeze"), skip_to_main = false, converged = false;
+	current_iteration = 0;
+	iteration_done = vector < unsigned int > (iteration_counts.size(), 0);
+	store_changes = vector < double > (G.n_ind, 0.0);
+	frozen = vector < bool > (G.n_ind, false);
+	if (freezing) {
+		stable_iterations = vector < unsigned int > (G.n_ind, 0);
+		stable_transitions = vector < unsigned int > (G.n_ind, 0);
+		frozen_neighbours = vector < vector < int > > (G.n_ind);
+		for (int i = 0 ; i < G.n_ind ; i ++) stable_transitions[i] = G.vecG[i]->n_transitions;
+	}
+
+	//Resume from a checkpoint: restore the state and jump to the next iteration to run
+	unsigned int first_stage = 0, first_iter = 0;
+	if (options.count("resume")) {
+		vrb.title("Resume MCMC");
+		mcmc_state S;
+		checkpoint_reader(G, H).readCheckpoint(options["resume"].as < string > (), S);
+		if (S.scheme != options["mcmc-iterations"].as < string > () || S.iteration_done.size() != iteration_counts.size())
+			vrb.error("Checkpoint iteration scheme [" + S.scheme + "] does not match --mcmc-iterations");
+		first_stage = S.stage;
+		first_iter = S.iter;
+		current_iteration = S.current_iteration;
+		n_main_iterations = S.n_main_iterations;
+		n_old_segments = S.n_old_segments;
+		n_prev_segments = S.n_prev_segments;
+		skip_to_main = S.skip_to_main;
+		iteration_done = S.iteration_done;
+		if (freezing && S.frozen.size() == G.n_ind && S.frozen_neighbours.size() == G.n_ind) {
+			frozen = S.frozen;
+			stable_iterations = S.stable_iterations;
+			stable_transitions = S.stable_transitions;
+			frozen_neighbours = S.frozen_neighbours;
+		}
+		H.transposeHaplotypes_H2V(false);
+		G.compact();
+		if (options.count("use-PS")) G.masking();
+		vrb.bullet("Resuming at iteration " + stb.str(current_iteration + 1) + " / Done so far: " + get_iteration_scheme(iteration_done));
+	}
+	for (iteration_stage = first_stage ; iteration_stage < iteration_counts.size() && !converged ; iteration_stage ++) {
+		if (skip_to_main && iteration_types[iteration_stage] != STAGE_MAIN) continue;
+		for (int iter = (iteration_stage == first_stage)?first_iter:0 ; iter < iteration_counts[iteration_stage] ; iter ++) {
+			//Save the state reached by the previous iteration
+			if (checkpoint.active() && (iteration_stage != first_stage || iter != first_iter)) saveCheckpoint(iteration_stage, iter, n_main_iterations, n_old_segments, n_prev_segments, skip_to_main);
 			switch (iteration_types[iteration_stage]) {
 			case STAGE_BURN:	vrb.title("Burn-in iteration [" + stb.str(iter+1) + "/" + stb.str(iteration_counts[iteration_stage]) + "]"); break;
 			case STAGE_PRUN:	vrb.title("Pruning iteration [" + stb.str(iter+1) + "/" + stb.str(iteration_counts[iteration_stage]) + "]"); break;
 			case STAGE_MAIN:	vrb.title("Main iteration [" + stb.str(iter+1) + "/" + stb.str(iteration_counts[iteration_stage]) + "]"); break;
 			}
+			switch (iteration_types[iteration_stage]) {
+			case STAGE_BURN:	perf.setIteration(current_iteration, "burn"); trace.setIteration(current_iteration, "burn"); break;
+			case STAGE_PRUN:	perf.setIteration(current_iteration, "prune"); trace.setIteration(current_iteration, "prune"); break;
+			case STAGE_MAIN:	perf.setIteration(current_iteration, "main"); trace.setIteration(current_iteration, "main"); break;
+			}
+			perf.begin("transpose_V2H");
 			H.transposeHaplotypes_V2H(false);
+			perf.end();
 			//H.searchIBD2matching(G, V, min(V.lengthcM(), options["ibd2-length"].as < double > ()), options["window"].as < double > ()*0.5f, ibd2_maf, options["ibd2-mdr"].as < double > (), ibd2_count);
+			perf.begin("pbwt_select");
 			H.updatePBWTmapping();
 			H.selectPBWTarrays();
 			H.transposePBWTarrays();
+			perf.end();
+			//All individuals store transition probabilities at least once
+			if (freezing) reactivateFrozen(iteration_types[iteration_stage] == STAGE_MAIN && n_main_iterations == 0);
+			perf.begin("hmm");
 			phaseWindow();
+			perf.end();
+			perf.begin("ibd2_merge");
 			H.mergeIBD2constraints();
+			perf.end();
+			perf.begin("hap_update");
 			H.updateHaplotypes(G);
+			perf.end();
+			perf.begin("transpose_H2V");
 			H.transposeHaplotypes_H2V(false);
+			perf.end();
+			double rate_trimmed = 0.0;
 			if (iteration_types[iteration_stage] == STAGE_PRUN) {
+				perf.begin("trimming");
 				n_new_segments = G.numberOfSegments();
 				vrb.bullet("Trimming [pc=" + stb.str((1-n_new_segments*1.0/n_old_segments)*100, 2) + "%]");
+				rate_trimmed = 1 - n_new_segments*1.0/max(n_prev_segments, 1UL);
+				n_prev_segments = n_new_segments;
 				if (options.count("use-PS")) G.masking();
+				G.compact();
+				perf.end();
+			}
+			if (iteration_types[iteration_stage] == STAGE_MAIN && iter == 0) {
+				perf.begin("compaction");
+				G.compact();
+				perf.end();
+			}
+			if (freezing) freezeConverged();
+			if (iteration_types[iteration_stage] == STAGE_MAIN) n_main_iterations ++;
+			iteration_done[iteration_stage] ++;
+			current_iteration ++;
+
+			//Adaptive schedule: stop the stage [or the remaining pre-main stages] once the chain no longer moves
+			if (adaptive) {
+				unsigned long n_changes = 0, n_hets = 0;
+				for (int i = 0 ; i < G.n_ind ; i ++) { n_changes += H.phase_changes[i]; n_hets += H.phase_hets[i]; }
+				double rate_phase = n_changes * 1.0 / max(n_hets, 1UL), store_change = 0.0;
+				unsigned int n_phased = 0;
+				for (int i = 0 ; i < G.n_ind ; i ++) if (store_changes[i] >= 0.0) { store_change += store_changes[i]; n_phased ++; }
+				store_change /= max(n_phased, 1U);
+				string str = "Convergence [phase=" + stb.str(rate_phase * 100, 3) + "%";
+				if (iteration_types[iteration_stage] == STAGE_PRUN) str += " / trimmed=" + stb.str(rate_trimmed * 100, 2) + "%";
+				if (iteration_types[iteration_stage] == STAGE_MAIN && n_main_iterations > 1) str += " / store=" + stb.str(store_change, 5);
+				vrb.bullet(str + "]");
+				bool stop = false;
+				switch (iteration_types[iteration_stage]) {
+				case STAGE_BURN:	stop = (rate_phase < options["mcmc-adaptive-phase"].as < double > ());
+									break;
+				case STAGE_PRUN:	stop = skip_to_main = (rate_phase < options["mcmc-adaptive-phase"].as < double > () && rate_trimmed < options["mcmc-adaptive-prune"].as < double > ());
+									break;
+				case STAGE_MAIN:	stop = converged = (n_main_iterations > 1 && store_change < options["mcmc-adaptive-store"].as < double > ());
+									break;
+				}
+				if (stop) break;
 			}
 		}
 	}
+	perf.endIterations();
+	checkpoint.wait();
+	if (adaptive) {
+		unsigned int n_planned = 0, n_done = 0;
+		for (int s = 0 ; s < iteration_counts.size() ; s ++) { n_planned += iteration_counts[s]; n_done += iteration_done[s]; }
+		vrb.title("Adaptive MCMC");
+		vrb.bullet("Schedule : " + get_iteration_scheme(iteration_done) + " / " + stb.str(n_planned - n_done) + " of " + stb.str(n_planned) + " iterations skipped");
+	}
 }
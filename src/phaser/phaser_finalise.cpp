@@ -23,22 +23,57 @@
 
 #include <io/haplotype_writer.h>
 #include <io/graph_writer.h>
+#include <modules/graph_solver.h>
 
 void phaser::write_files_and_finalise() {
 	vrb.title("Finalization:");
 
 	//step0: multi-threading
 	if (options["thread"].as < int > () > 1) pthread_mutex_destroy(&mutex_workers);
+	if (trace.active()) {
+		trace.close();
+		vrb.bullet("HMM trace written in [" + options["hmm-trace"].as < string > () + "]");
+	}
 
 	//
-	G.solve();
+	if (options["bingraph-bits"].as < int > () < 32) {
+		perf.begin("quantize");
+		G.quantize(options["bingraph-bits"].as < int > ());
+		perf.end();
+	}
+	perf.begin("solve");
+	graph_solver(G, options["thread"].as < int > ()).solve();
+	perf.end();
+	perf.begin("hap_update");
 	H.updateHaplotypes(G);
+	perf.end();
+	perf.begin("transpose_H2V");
 	H.transposeHaplotypes_H2V(false);
+	perf.end();
 
 	//step1: writing best guess haplotypes in VCF/BCF file
-	if (options.count("bingraph")) graph_writer(G, V).writeGraphs(options["bingraph"].as < string > ());
-	if (options.count("output")) haplotype_writer(H, G, V, options["thread"].as < int > ()).writeHaplotypes(options["output"].as < string > ());
+	if (options.count("bingraph")) {
+		perf.begin("write_bingraph");
+		graph_writer(G, V, !options.count("bingraph-mmap")).writeGraphs(options["bingraph"].as < string > ());
+		perf.end();
+	}
+	if (options.count("output")) {
+		perf.begin("write_vcf");
+		haplotype_writer(H, G, V, options["thread"].as < int > ()).writeHaplotypes(options["output"].as < string > ());
+		perf.end();
+	}
 
 	//step2: Measure overall running time
 	vrb.bullet("Total running time = " + stb.str(tac.abs_time()) + " seconds");
+
+	//step3: Performance report
+	if (perf.countersEnabled()) {
+		vector < string > lines = perf.summary(V.size() * 1.0 * H.n_hap);
+		for (int l = 0 ; l < lines.size() ; l ++) vrb.bullet("PMU " + lines[l]);
+	}
+	if (options.count("perf-report")) {
+		if (!perf.write(options["perf-report"].as < string > (), SHAPEIT_VERSION, options["thread"].as < int > (), G.n_ind, V.size(), H.n_hap, peakRSS()))
+			vrb.error("Impossible to create performance report [" + options["perf-report"].as < string > () + "]");
+		vrb.bullet("Performance report written in [" + options["perf-report"].as < string > () + "]");
+	}
 }
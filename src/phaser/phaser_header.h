@@ -33,6 +33,11 @@
 #include <containers/haplotype_set.h>
 #include <containers/variant_map.h>
 
+#include <io/trace_writer.h>
+#include <io/checkpoint_writer.h>
+
+
+#define SHAPEIT_VERSION	"4.2.2"
 
 #define STAGE_BURN	0
 #define STAGE_PRUN	1
@@ -59,8 +64,15 @@ public:
 	//MCMC
 	vector < unsigned int > iteration_types;
 	vector < unsigned int > iteration_counts;
+	vector < unsigned int > iteration_done;
 	unsigned int iteration_stage;
+	unsigned long current_iteration;
 	int n_underflow_recovered;
+	vector < double > store_changes;				// Change brought by the last storage event of each individual [-1 if frozen during this iteration]
+	vector < bool > frozen;							// Individuals skipped by the HMM job queue (--mcmc-freeze)
+	vector < unsigned int > stable_iterations;		// #consecutive iterations without change of haplotypes nor graph
+	vector < unsigned int > stable_transitions;		// #transitions of the graph at the previous iteration
+	vector < vector < int > > frozen_neighbours;	// PBWT neighbours at the time of freezing
 
 	//PARAMETERS
 	double pbwt_modulo;
@@ -71,6 +83,14 @@ public:
 	basic_stats statH,statS;
 	vector < double > storedKsizes;
 
+	//PERFORMANCE
+	perf_report perf;
+	trace_writer trace;
+	std::chrono::steady_clock::time_point trace_origin;
+
+	//CHECKPOINT
+	checkpoint_writer checkpoint;
+
 	//CONSTRUCTOR
 	phaser();
 	~phaser();
@@ -79,12 +99,15 @@ public:
 	void phase();
 	void phaseWindow(int, int);
 	void phaseWindow();
+	void reactivateFrozen(bool);
+	void freezeConverged();
+	void saveCheckpoint(unsigned int, unsigned int, unsigned long, unsigned long, unsigned long, bool);
 
 	//PARAMETERS
 	void declare_options();
 	void parse_command_line(vector < string > &);
 	void parse_iteration_scheme(string);
-	string get_iteration_scheme();
+	string get_iteration_scheme(vector < unsigned int > &);
 	void check_options();
 	void verbose_options();
 	void verbose_files();
@@ -38,8 +38,11 @@ void phaser::read_files_and_initialise() {
 		id_workers = vector < pthread_t > (options["thread"].as < int > ());
 		pthread_mutex_init(&mutex_workers, NULL);
 	}
+	if (options.count("perf-counters") && !perf.enableCounters())
+		vrb.warning("Hardware performance counters are not available [check /proc/sys/kernel/perf_event_paranoid], --perf-counters is ignored");
 
 	//step2: Read input files
+	perf.begin("read");
 	genotype_reader readerG(H, G, V, options["region"].as < string > (), options.count("use-PS"), options["thread"].as < int > ());
 	if (!options.count("reference")) readerG.scanGenotypes(options["input"].as < string > ());
 	else readerG.scanGenotypes(options["input"].as < string > (), options["reference"].as < string > ());
@@ -49,17 +52,21 @@ void phaser::read_files_and_initialise() {
 	if (!options.count("reference") &&  options.count("scaffold")) readerG.readGenotypes2(options["input"].as < string > (), options["scaffold"].as < string > ());
 	if ( options.count("reference") &&  options.count("scaffold")) readerG.readGenotypes3(options["input"].as < string > (), options["reference"].as < string > (), options["scaffold"].as < string > ());
 	G.imputeMonomorphic(V);
+	perf.end();
 
 	//step3: Read and initialise genetic map
+	perf.begin("genetic_map");
 	if (options.count("map")) {
 		gmap_reader readerGM;
-		readerGM.readGeneticMapFile(options["map"].as < string > ());
+		string fcache = options.count("map-cache-file")?options["map-cache-file"].as < string > ():(options.count("map-cache")?(options["map"].as < string > () + ".cache"):"");
+		readerGM.readGeneticMapFile(options["map"].as < string > (), V.vec_pos[0]->bp, V.vec_pos.back()->bp, fcache);
 		V.setGeneticMap(readerGM);
 	} else V.setGeneticMap();
 	M.initialise(V, options["effective-size"].as < int > (), (readerG.n_main_samples+readerG.n_ref_samples)*2);
+	perf.end();
 
 	//step4: Initialize haplotypes
-
+	perf.begin("pbwt_init");
 	H.parametrizePBWT(options["pbwt-depth"].as < int > (), pbwt_modulo, options["pbwt-mac"].as < int > (), options["pbwt-mdr"].as < double > (), options["thread"].as < int > ());
 	H.initializePBWTmapping(V);
 	H.allocatePBWTarrays();
@@ -67,18 +74,33 @@ void phaser::read_files_and_initialise() {
 	H.transposeHaplotypes_H2V(true);
 
 
-	if (!options.count("pbwt-disable-init")) {
+	//PBWT initialization is overwritten by the resumed haplotypes
+	if (!options.count("pbwt-disable-init") && !options.count("resume")) {
 		pbwt_solver solver = pbwt_solver(H);
 		solver.sweep(G);
 		solver.free();
 	}
+	perf.end();
 
 	//step5: Initialize genotype structures
+	perf.begin("build");
 	builder(G, options["thread"].as < int > ()).build();
+	G.compact();
 	if (options.count("use-PS")) G.masking();
+	perf.end();
 
 	//step6: Allocate data structures for computations
 	unsigned int max_number_transitions = G.largestNumberOfTransitions();
 	unsigned int max_number_missing = G.largestNumberOfMissings();
 	threadData = vector < compute_job >(options["thread"].as < int > (), compute_job(V, G, H, max_number_transitions, max_number_missing));
+
+	//step7: Open checkpoint file
+	if (options.count("checkpoint")) checkpoint.open(options["checkpoint"].as < string > ());
+
+	//step8: Open per-sample HMM trace
+	if (options.count("hmm-trace")) {
+		trace.open(options["hmm-trace"].as < string > ());
+		trace_origin = std::chrono::steady_clock::now();
+		for (int t = 0 ; t < threadData.size() ; t++) threadData[t].Trace.reserve(TRACE_BUFFER_SIZE);
+	}
 }
@@ -59,13 +59,13 @@ void phaser::parse_iteration_scheme(string str_iter) {
 	}
 }
 
-string phaser::get_iteration_scheme() {
+string phaser::get_iteration_scheme(vector < unsigned int > & counts) {
 	int n_total_iter = 0;
-	for (int s = 0 ; s < iteration_counts.size() ; s ++) n_total_iter += iteration_counts[s];
+	for (int s = 0 ; s < counts.size() ; s ++) n_total_iter += counts[s];
 
 	string str = stb.str(n_total_iter) + " iterations [";
-	for (int s = 0 ; s < iteration_counts.size() ; s ++) {
-		str += (s?" + ":"") + stb.str(iteration_counts[s]);
+	for (int s = 0 ; s < counts.size() ; s ++) {
+		str += (s?" + ":"") + stb.str(counts[s]);
 		switch (iteration_types[s]) {
 		case STAGE_BURN:	str+= "b"; break;
 		case STAGE_PRUN:	str+= "p"; break;
@@ -35,6 +35,8 @@ void phaser::declare_options() {
 			("reference,H", bpo::value< string >(), "Reference panel of haplotypes in VCF/BCF format")
 			("scaffold,S", bpo::value< string >(), "Scaffold of haplotypes in VCF/BCF format")
 			("map,M", bpo::value< string >(), "Genetic map")
+			("map-cache", "Cache the parsed genetic map in binary next to the map file [MAP.cache] to speed up subsequent runs")
+			("map-cache-file", bpo::value< string >(), "Cache the parsed genetic map in this file instead [useful when the map directory is read-only]")
 			("region,R", bpo::value< string >(), "Target region")
 			("use-PS", bpo::value<double>(), "Informs phasing using PS field from read based phasing")
 			("sequencing", "Default parameter setting for sequencing data (this divides by 50 the default value of --pbwt-modulo)");
@@ -42,7 +44,13 @@ void phaser::declare_options() {
 	bpo::options_description opt_mcmc ("MCMC parameters");
 	opt_mcmc.add_options()
 			("mcmc-iterations", bpo::value<string>()->default_value("5b,1p,1b,1p,1b,1p,5m"), "Iteration scheme of the MCMC")
-			("mcmc-prune", bpo::value<double>()->default_value(0.999), "Pruning threshold for genotype graphs");
+			("mcmc-prune", bpo::value<double>()->default_value(0.999), "Pruning threshold for genotype graphs")
+			("mcmc-adaptive", "Ends stages of the iteration scheme early once the MCMC has converged (stage sizes become maxima)")
+			("mcmc-adaptive-phase", bpo::value<double>()->default_value(0.001), "Adaptive MCMC: rate of het phase changes per iteration below which burn-in ends")
+			("mcmc-adaptive-prune", bpo::value<double>()->default_value(0.01), "Adaptive MCMC: rate of segments trimmed per iteration below which remaining burn-in/pruning stages are skipped")
+			("mcmc-adaptive-store", bpo::value<double>()->default_value(0.001), "Adaptive MCMC: mean change of stored transition probabilities below which main iterations end")
+			("mcmc-freeze", bpo::value<int>(), "Skips HMM computations of individuals whose haplotypes and graph did not change for this number of iterations")
+			("mcmc-freeze-pbwt", bpo::value<double>()->default_value(0.25), "Re-activates a frozen individual when this fraction of its PBWT neighbours has changed");
 
 	bpo::options_description opt_pbwt ("PBWT parameters");
 	opt_pbwt.add_options()
@@ -50,7 +58,8 @@ void phaser::declare_options() {
 			("pbwt-depth", bpo::value< int >()->default_value(4), "Depth of PBWT indexes to condition on")
 			("pbwt-mac", bpo::value< int >()->default_value(2), "Minimal Minor Allele Count at which PBWT is evaluated")
 			("pbwt-mdr", bpo::value< double >()->default_value(0.50), "Maximal Missing Data Rate at which PBWT is evaluated")
-			("pbwt-disable-init", "Disable initialization by PBWT sweep");
+			("pbwt-disable-init", "Disable initialization by PBWT sweep")
+			("resume", bpo::value< string >(), "Resume the MCMC from a state saved with --checkpoint [same input files and MCMC options]");
 	
 	bpo::options_description opt_ibd2 ("IBD2 parameters [DEPRECATED]");
 	opt_ibd2.add_options()
@@ -69,7 +78,13 @@ void phaser::declare_options() {
 	opt_output.add_options()
 			("output,O", bpo::value< string >(), "Phased haplotypes in VCF/BCF format")
 			("bingraph", bpo::value< string >(), "Phased haplotypes in BIN format [Useful to sample multiple likely haplotype configurations per sample]")
-			("log", bpo::value< string >(), "Log file");
+			("bingraph-mmap", "Write the BIN file uncompressed with aligned arrays so that bingraphsample can memory map it")
+			("bingraph-bits", bpo::value< int >()->default_value(32), "Precision of the phase probabilities kept after the last main iteration and written in BIN format [32 (float), 16 or 8 bits]")
+			("log", bpo::value< string >(), "Log file")
+			("checkpoint", bpo::value< string >(), "Save the MCMC state in this file at every iteration boundary [written in background, see --resume]")
+			("perf-report", bpo::value< string >(), "Per-stage timings, HMM statistics and peak memory usage in JSON format")
+			("perf-counters", "Collect hardware performance counters (cycles, instructions, LLC and branch misses) per stage and per worker thread [Linux only]")
+			("hmm-trace", bpo::value< string >(), "Per-sample HMM cost trace for each iteration [TSV, or Chrome trace-event format if the file name contains .json]");
 
 	descriptions.add(opt_base).add(opt_input).add(opt_mcmc).add(opt_pbwt).add(opt_ibd2).add(opt_hmm).add(opt_output);
 }
@@ -88,7 +103,7 @@ void phaser::parse_command_line(vector < string > & args) {
 	vrb.title("SHAPEIT");
 	vrb.bullet("Author        : Olivier DELANEAU, University of Lausanne");
 	vrb.bullet("Contact       : olivier.delaneau@gmail.com");
-	vrb.bullet("Version       : 4.2.2");
+	vrb.bullet("Version       : " + string(SHAPEIT_VERSION));
 	vrb.bullet("Run date      : " + tac.date());
 }
 
@@ -102,15 +117,18 @@ void phaser::check_options() {
 	if ((options.count("output")+options.count("bingraph"))==0)
 		vrb.error("You must specify a phased output file with --output");
 
+	if (options.count("bingraph-mmap") && !options.count("bingraph"))
+		vrb.error("You must specify a BIN file with --bingraph to use --bingraph-mmap");
+
+	if (options["bingraph-bits"].as < int > () != 32 && options["bingraph-bits"].as < int > () != 16 && options["bingraph-bits"].as < int > () != 8)
+		vrb.error("You must specify 32, 16 or 8 bits using --bingraph-bits");
+
 	if (options.count("seed") && options["seed"].as < int > () < 0)
 		vrb.error("Random number generator needs a positive seed value");
 
 	if (options.count("thread") && options["thread"].as < int > () < 1)
 		vrb.error("You must use at least 1 thread");
 
-	if (!options["thread"].defaulted() && !options["seed"].defaulted())
-		vrb.warning("Using multi-threading prevents reproducing a run by specifying --seed");
-
 	if (!options["effective-size"].defaulted() && options["effective-size"].as < int > () < 1)
 		vrb.error("You must specify a positive effective size");
 
@@ -128,6 +146,21 @@ void phaser::check_options() {
 		vrb.warning("All --ibd2-* options are deprecated. Not used anymore as SHAPEIT versions >= 4.2.0 incorporates better methods for mapping IBD2 tracks");
 
 
+	if (options["mcmc-adaptive-phase"].as < double > () < 0 || options["mcmc-adaptive-phase"].as < double > () > 1 || options["mcmc-adaptive-prune"].as < double > () < 0 || options["mcmc-adaptive-prune"].as < double > () > 1 || options["mcmc-adaptive-store"].as < double > () < 0 || options["mcmc-adaptive-store"].as < double > () > 1)
+		vrb.error("You must specify --mcmc-adaptive-* thresholds comprised between 0 and 1");
+
+	if (!options.count("mcmc-adaptive") && (!options["mcmc-adaptive-phase"].defaulted() || !options["mcmc-adaptive-prune"].defaulted() || !options["mcmc-adaptive-store"].defaulted()))
+		vrb.warning("Options --mcmc-adaptive-* have no effect without --mcmc-adaptive");
+
+	if (options.count("mcmc-freeze") && options["mcmc-freeze"].as < int > () < 1)
+		vrb.error("You must specify a positive number of iterations using --mcmc-freeze");
+
+	if (options["mcmc-freeze-pbwt"].as < double > () < 0 || options["mcmc-freeze-pbwt"].as < double > () > 1)
+		vrb.error("You must specify --mcmc-freeze-pbwt comprised between 0 and 1");
+
+	if (options.count("checkpoint") && options.count("resume") && options["checkpoint"].as < string > () == options["resume"].as < string > ())
+		vrb.warning("Using the same file for --checkpoint and --resume overwrites the resumed state at the next iteration");
+
 	parse_iteration_scheme(options["mcmc-iterations"].as < string > ());
 }
 
@@ -138,15 +171,21 @@ void phaser::verbose_files() {
 	if (options.count("scaffold")) vrb.bullet("Scaffold VCF  : [" + options["scaffold"].as < string > () + "]");
 	if (options.count("map")) vrb.bullet("Genetic Map   : [" + options["map"].as < string > () + "]");
 	if (options.count("output")) vrb.bullet("Output VCF    : [" + options["output"].as < string > () + "]");
-	if (options.count("bingraph")) vrb.bullet("Output BIN    : [" + options["bingraph"].as < string > () + "]");
+	if (options.count("bingraph")) vrb.bullet("Output BIN    : [" + options["bingraph"].as < string > () + "]" + ((options["bingraph-bits"].as < int > () < 32)?(" / " + stb.str(options["bingraph-bits"].as < int > ()) + " bits"):"") + (options.count("bingraph-mmap")?" / aligned":""));
+	if (options.count("resume")) vrb.bullet("Resume from   : [" + options["resume"].as < string > () + "]");
+	if (options.count("checkpoint")) vrb.bullet("Checkpoint    : [" + options["checkpoint"].as < string > () + "]");
 	if (options.count("log")) vrb.bullet("Output LOG    : [" + options["log"].as < string > () + "]");
+	if (options.count("perf-report")) vrb.bullet("Output PERF   : [" + options["perf-report"].as < string > () + "]");
+	if (options.count("hmm-trace")) vrb.bullet("Output TRACE  : [" + options["hmm-trace"].as < string > () + "]");
 }
 
 void phaser::verbose_options() {
 	vrb.title("Parameters:");
 	vrb.bullet("Seed    : " + stb.str(options["seed"].as < int > ()));
 	vrb.bullet("Threads : " + stb.str(options["thread"].as < int > ()) + " threads");
-	vrb.bullet("MCMC    : " + get_iteration_scheme());
+	vrb.bullet("MCMC    : " + get_iteration_scheme(iteration_counts));
+	if (options.count("mcmc-adaptive")) vrb.bullet("MCMC    : Adaptive schedule [phase<" + stb.str(options["mcmc-adaptive-phase"].as < double > (), 4) + " / prune<" + stb.str(options["mcmc-adaptive-prune"].as < double > (), 4) + " / store<" + stb.str(options["mcmc-adaptive-store"].as < double > (), 4) + "]");
+	if (options.count("mcmc-freeze")) vrb.bullet("MCMC    : Freeze individuals stable for " + stb.str(options["mcmc-freeze"].as < int > ()) + " iterations / Re-activate when >" + stb.str(options["mcmc-freeze-pbwt"].as < double > () * 100, 1) + "% of PBWT neighbours change");
 	vrb.bullet("PBWT    : Depth of PBWT neighbours to condition on: " + stb.str(options["pbwt-depth"].as < int > ()));
 	vrb.bullet("PBWT    : Store indexes at variants [MAC>=" + stb.str(options["pbwt-mac"].as < int > ()) + " / MDR<=" + stb.str(options["pbwt-mdr"].as < double > ()) + " / Dist=" + stb.str(pbwt_modulo) + " cM]");
 	vrb.bullet("HMM     : K is variable / min W is " + stb.str(options["window"].as < double > (), 2) + "cM / Ne is "+ stb.str(options["effective-size"].as < int > ()));
@@ -33,6 +33,8 @@ protected:
 	double m_newM;
 	double m_oldS;
 	double m_newS;
+	double m_min;
+	double m_max;
 
 public:
 	basic_stats() {
@@ -41,6 +43,8 @@ public:
 		m_newM = 0;
 		m_oldS = 0;
 		m_newS = 0;
+		m_min = 0;
+		m_max = 0;
 	}
 
 	template <class T>
@@ -50,6 +54,8 @@ public:
 		m_newM = 0;
 		m_oldS = 0;
 		m_newS = 0;
+		m_min = 0;
+		m_max = 0;
 		for (uint32_t e = 0 ; e < X.size() ; e ++) push(X[e]);
 	}
 
@@ -59,6 +65,8 @@ public:
 		m_newM = 0;
 		m_oldS = 0;
 		m_newS = 0;
+		m_min = 0;
+		m_max = 0;
 	}
 
 	template <class T>
@@ -67,7 +75,10 @@ public:
 		if (m_n == 1) {
 			m_oldM = m_newM = x;
 			m_oldS = 0.0;
+			m_min = m_max = x;
 		} else {
+			m_min = (x < m_min)?x:m_min;
+			m_max = (x > m_max)?x:m_max;
 			m_newM = m_oldM + (x - m_oldM)/m_n;
             m_newS = m_oldS + (x - m_oldM)*(x - m_newM);
             m_oldM = m_newM;
@@ -90,6 +101,14 @@ public:
 	double sd() const {
 		return sqrt( variance() );
 	}
+
+	double min() const {
+		return m_min;
+	}
+
+	double max() const {
+		return m_max;
+	}
 };
 
 #endif
@@ -0,0 +1,78 @@
+/*******************************************************************************
+ * Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+#ifndef _BIT_VECTOR_H
+#define _BIT_VECTOR_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+//Bit array packed in 64 bits words [bit i is bit (i&63) of word (i>>6), i.e. bit (i&7) of byte (i>>3) on little endian machines]
+//Optional rank support: number of set bits before each word, so that set bits can index a dense companion array
+class bit_vector {
+protected:
+	std::vector < uint64_t > words;
+	std::vector < unsigned int > ranks;
+	size_t n;
+
+public:
+	bit_vector() {
+		n = 0;
+	}
+
+	void allocate(size_t _n, bool _val = false) {
+		n = _n;
+		words = std::vector < uint64_t > ((n + 63) >> 6, _val?~0UL:0UL);
+		if (_val && (n & 63)) words.back() = (1UL << (n & 63)) - 1;
+		std::vector < unsigned int > ().swap(ranks);
+	}
+
+	void clear() {
+		std::vector < uint64_t > ().swap(words);
+		std::vector < unsigned int > ().swap(ranks);
+		n = 0;
+	}
+
+	//Prefix popcounts per word; to be called once the bits are final
+	unsigned int buildRank() {
+		ranks = std::vector < unsigned int > (words.size() + 1, 0);
+		for (size_t w = 0 ; w < words.size() ; w ++) ranks[w+1] = ranks[w] + __builtin_popcountl(words[w]);
+		return ranks.back();
+	}
+
+	size_t size() const { return n; }
+	size_t sizeWords() const { return words.size(); }
+	size_t sizeBytes() const { return (n + 7) >> 3; }
+	uint64_t word(size_t w) const { return words[w]; }
+	unsigned int rankWord(size_t w) const { return ranks[w]; }
+	const unsigned char * bytes() const { return reinterpret_cast < const unsigned char * > (words.data()); }
+
+	bool get(size_t i) const { return (words[i >> 6] >> (i & 63)) & 1UL; }
+	bool operator [] (size_t i) const { return get(i); }
+	void set(size_t i) { words[i >> 6] |= (1UL << (i & 63)); }
+	void unset(size_t i) { words[i >> 6] &= ~(1UL << (i & 63)); }
+
+	//Number of set bits strictly before position i [requires buildRank]
+	unsigned int rank(size_t i) const { return ranks[i >> 6] + __builtin_popcountl(words[i >> 6] & ((1UL << (i & 63)) - 1)); }
+};
+
+#endif
@@ -0,0 +1,107 @@
+/*******************************************************************************
+ * Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+#ifndef _COUNTER_RNG_H
+#define _COUNTER_RNG_H
+
+#include <cstdint>
+#include <vector>
+
+//Counter-based random number generator [Philox4x32-10, Salmon et al. 2011]
+//Each (seed, stream) pair gives an independent sequence, so that results do not depend on which thread consumes it.
+class counter_rng {
+protected:
+	uint32_t key [2];
+	uint32_t ctr [4];
+	uint32_t out [4];
+	unsigned int n_out;
+
+	static inline void mulhilo(uint32_t a, uint32_t b, uint32_t & hi, uint32_t & lo) {
+		uint64_t p = (uint64_t)a * b;
+		hi = (uint32_t)(p >> 32);
+		lo = (uint32_t)p;
+	}
+
+	void generate() {
+		uint32_t c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3], k0 = key[0], k1 = key[1], hi0, lo0, hi1, lo1;
+		for (int r = 0 ; r < 10 ; r ++) {
+			mulhilo(0xD2511F53U, c0, hi0, lo0);
+			mulhilo(0xCD9E8D57U, c2, hi1, lo1);
+			c0 = hi1 ^ c1 ^ k0; c1 = lo1;
+			c2 = hi0 ^ c3 ^ k1; c3 = lo0;
+			k0 += 0x9E3779B9U; k1 += 0xBB67AE85U;
+		}
+		out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+		if (!++ctr[0]) ++ctr[1];
+		n_out = 4;
+	}
+
+public:
+	counter_rng(uint64_t seed = 15052011, uint64_t stream = 0) {
+		setStream(seed, stream);
+	}
+
+	~counter_rng() {
+	}
+
+	void setStream(uint64_t seed, uint64_t stream) {
+		key[0] = (uint32_t)seed;
+		key[1] = (uint32_t)(seed >> 32) ^ 0x5DEECE66U;
+		ctr[0] = 0; ctr[1] = 0;
+		ctr[2] = (uint32_t)stream;
+		ctr[3] = (uint32_t)(stream >> 32);
+		n_out = 0;
+	}
+
+	uint32_t getUInt32() {
+		if (!n_out) generate();
+		return out[--n_out];
+	}
+
+	unsigned int getInt(unsigned int isize) {
+		return (unsigned int)(((uint64_t)getUInt32() * isize) >> 32);
+	}
+
+	unsigned int getInt(unsigned int imin, unsigned int imax) {
+		return imin + getInt(imax - imin + 1);
+	}
+
+	double getDouble() {
+		uint64_t a = getUInt32() >> 5, b = getUInt32() >> 6;
+		return (a * 67108864.0 + b) * (1.0 / 9007199254740992.0);
+	}
+
+	bool flipCoin() {
+		return (getDouble() < 0.5);
+	}
+
+	int sample(const double * vec, unsigned int n, double sum) {
+		double csum = vec[0];
+		double u = getDouble() * sum;
+		for (int i = 0; i < n - 1; ++i) {
+			if ( u < csum ) return i;
+			csum += vec[i+1];
+		}
+		return n - 1;
+	}
+};
+
+#endif
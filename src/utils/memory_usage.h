@@ -0,0 +1,52 @@
+/*******************************************************************************
+ * Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+#ifndef _MEMORY_USAGE_H
+#define _MEMORY_USAGE_H
+
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+//Resident set size of the current process in bytes [0 when /proc is not available]
+inline
+unsigned long currentRSS() {
+	unsigned long vm_pages = 0, rss_pages = 0;
+	FILE * fd = fopen("/proc/self/statm", "r");
+	if (!fd) return 0;
+	if (fscanf(fd, "%lu %lu", &vm_pages, &rss_pages) != 2) rss_pages = 0;
+	fclose(fd);
+	return rss_pages * sysconf(_SC_PAGESIZE);
+}
+
+//Peak resident set size of the current process in bytes [0 when /proc is not available]
+inline
+unsigned long peakRSS() {
+	unsigned long peak_kb = 0;
+	char line [256];
+	FILE * fd = fopen("/proc/self/status", "r");
+	if (!fd) return 0;
+	while (fgets(line, 256, fd)) if (!strncmp(line, "VmHWM:", 6)) { sscanf(line + 6, "%lu", &peak_kb); break; }
+	fclose(fd);
+	return peak_kb * 1024;
+}
+
+#endif
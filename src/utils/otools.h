@@ -58,11 +58,18 @@ extern "C" {
 //INCLUDES BASE STUFFS
 #include <utils/compressed_io.h>
 #include <utils/random_number.h>
+#include <utils/counter_rng.h>
 #include <utils/basic_stats.h>
 #include <utils/basic_algos.h>
 #include <utils/string_utils.h>
 #include <utils/timer.h>
 #include <utils/verbose.h>
+#include <utils/buffer_view.h>
+#include <utils/bit_vector.h>
+#include <utils/memory_usage.h>
+#include <utils/workspace_arena.h>
+#include <utils/perf_counters.h>
+#include <utils/perf_report.h>
 
 //CONSTANTS
 #define RARE_VARIANT_FREQ	0.001f
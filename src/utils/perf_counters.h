@@ -0,0 +1,136 @@
+/*******************************************************************************
+ * Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+#ifndef _PERF_COUNTERS_H
+#define _PERF_COUNTERS_H
+
+#include <cstring>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#define PMU_CYCLES			0
+#define PMU_INSTRUCTIONS	1
+#define PMU_LLC_MISSES		2
+#define PMU_BRANCH_MISSES	3
+#define PMU_NUMBER			4
+
+//Hardware performance counters of the calling thread [and of the threads it creates when inherited], read through perf_event_open.
+//Counters the kernel refuses (perf_event_paranoid, virtual machines, other OS) are reported as -1.
+//Inherited counts of exited threads survive PERF_EVENT_IOC_RESET, so stop() returns the difference with the values read in start().
+class perf_counters {
+protected:
+	int fd [PMU_NUMBER];
+	long base [PMU_NUMBER];
+
+	long read(int c) {
+		long long count = 0;
+#ifdef __linux__
+		if (fd[c] >= 0 && ::read(fd[c], &count, sizeof(count)) == sizeof(count)) return count;
+#endif
+		return -1;
+	}
+
+public:
+	perf_counters() {
+		for (int c = 0 ; c < PMU_NUMBER ; c ++) { fd[c] = -1; base[c] = 0; }
+	}
+
+	//File descriptors are never shared: copies start closed
+	perf_counters(const perf_counters & p) {
+		for (int c = 0 ; c < PMU_NUMBER ; c ++) { fd[c] = -1; base[c] = 0; }
+	}
+
+	perf_counters & operator = (const perf_counters & p) {
+		return *this;
+	}
+
+	~perf_counters() {
+		close();
+	}
+
+	static const char * name(int c) {
+		static const char * names [PMU_NUMBER] = {"cycles", "instructions", "llc_misses", "branch_misses"};
+		return names[c];
+	}
+
+	//Returns the number of counters that could be opened
+	int open(bool inherit) {
+		int n_open = 0;
+#ifdef __linux__
+		const unsigned long configs [PMU_NUMBER] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+		for (int c = 0 ; c < PMU_NUMBER ; c ++) {
+			struct perf_event_attr attr;
+			memset(&attr, 0, sizeof(attr));
+			attr.size = sizeof(attr);
+			attr.type = PERF_TYPE_HARDWARE;
+			attr.config = configs[c];
+			attr.disabled = 1;
+			attr.inherit = inherit;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			fd[c] = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+			n_open += (fd[c] >= 0);
+		}
+#endif
+		return n_open;
+	}
+
+	void close() {
+#ifdef __linux__
+		for (int c = 0 ; c < PMU_NUMBER ; c ++) if (fd[c] >= 0) ::close(fd[c]);
+#endif
+		for (int c = 0 ; c < PMU_NUMBER ; c ++) fd[c] = -1;
+	}
+
+	bool active() const {
+		for (int c = 0 ; c < PMU_NUMBER ; c ++) if (fd[c] >= 0) return true;
+		return false;
+	}
+
+	void start() {
+#ifdef __linux__
+		for (int c = 0 ; c < PMU_NUMBER ; c ++) if (fd[c] >= 0) {
+			base[c] = read(c);
+			ioctl(fd[c], PERF_EVENT_IOC_ENABLE, 0);
+		}
+#endif
+	}
+
+	void stop(long * values) {
+		for (int c = 0 ; c < PMU_NUMBER ; c ++) {
+			values[c] = -1;
+#ifdef __linux__
+			if (fd[c] >= 0) {
+				ioctl(fd[c], PERF_EVENT_IOC_DISABLE, 0);
+				long count = read(c);
+				if (count >= 0 && base[c] >= 0) values[c] = count - base[c];
+			}
+#endif
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,207 @@
+/*******************************************************************************
+ * Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+#ifndef _PERF_REPORT_H
+#define _PERF_REPORT_H
+
+#include <chrono>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+#include <utils/basic_stats.h>
+#include <utils/string_utils.h>
+#include <utils/perf_counters.h>
+
+//Structured record of where a run spends its time and memory, written as JSON with --perf-report
+class perf_report {
+protected:
+	struct stage_entry {
+		std::string name;
+		int iteration;				//-1 outside of the MCMC iterations
+		double wall, cpu;			//[seconds]
+		long counters [PMU_NUMBER];	//Hardware counters of the main thread and the workers it spawned [-1 if unavailable]
+	};
+
+	struct hmm_entry {
+		int iteration;
+		double k_mean, k_sd, k_min, k_max;
+		double w_mean, w_sd, w_min, w_max;
+		unsigned int n_windows;
+		int n_underflows;
+		double wall;
+		std::vector < double > busy;	//Time spent phasing samples by each worker thread [seconds]
+		std::vector < std::vector < long > > counters;	//Hardware counters of each worker thread [empty if disabled]
+	};
+
+	std::vector < stage_entry > stages;
+	std::vector < hmm_entry > hmms;
+	std::vector < std::string > iteration_types;
+	std::chrono::steady_clock::time_point start_run, start_stage;
+	std::clock_t cpu_run, cpu_stage;
+	std::string curr_stage;
+	int curr_iteration;
+	perf_counters pmu;
+
+	static std::string num(double x) {
+		std::ostringstream ss;
+		ss << std::setprecision(6) << x;
+		return ss.str();
+	}
+
+	static std::string counters(const long * values, double n_cells) {
+		std::string str = "{";
+		for (int c = 0 ; c < PMU_NUMBER ; c ++) str += std::string(c?", ":"") + "\"" + perf_counters::name(c) + "\": " + ((values[c] >= 0)?std::to_string(values[c]):"null");
+		str += ", \"ipc\": " + ((values[PMU_CYCLES] > 0 && values[PMU_INSTRUCTIONS] >= 0)?num(values[PMU_INSTRUCTIONS] * 1.0 / values[PMU_CYCLES]):"null");
+		str += ", \"llc_misses_per_cell\": " + ((values[PMU_LLC_MISSES] >= 0 && n_cells > 0)?num(values[PMU_LLC_MISSES] / n_cells):"null");
+		str += ", \"branch_misses_per_cell\": " + ((values[PMU_BRANCH_MISSES] >= 0 && n_cells > 0)?num(values[PMU_BRANCH_MISSES] / n_cells):"null");
+		return str + "}";
+	}
+
+public:
+	perf_report() {
+		start_run = std::chrono::steady_clock::now();
+		cpu_run = std::clock();
+		curr_iteration = -1;
+	}
+
+	~perf_report() {
+		stages.clear();
+		hmms.clear();
+	}
+
+	//Opt-in hardware counters around each stage; returns false when the kernel does not allow any
+	bool enableCounters() {
+		return pmu.open(true) > 0;
+	}
+
+	bool countersEnabled() const {
+		return pmu.active();
+	}
+
+	void setIteration(int iteration, std::string type) {
+		curr_iteration = iteration;
+		iteration_types.resize(iteration + 1);
+		iteration_types[iteration] = type;
+	}
+
+	void endIterations() {
+		curr_iteration = -1;
+	}
+
+	void begin(std::string name) {
+		curr_stage = name;
+		start_stage = std::chrono::steady_clock::now();
+		cpu_stage = std::clock();
+		pmu.start();
+	}
+
+	void end() {
+		stage_entry e;
+		pmu.stop(e.counters);
+		e.name = curr_stage;
+		e.iteration = curr_iteration;
+		e.wall = std::chrono::duration < double > (std::chrono::steady_clock::now() - start_stage).count();
+		e.cpu = (std::clock() - cpu_stage) * 1.0 / CLOCKS_PER_SEC;
+		stages.push_back(e);
+	}
+
+	void hmm(const basic_stats & K, const basic_stats & W, int n_underflows, const std::vector < double > & busy, const std::vector < std::vector < long > > & counters, double wall) {
+		hmm_entry e;
+		e.iteration = curr_iteration;
+		e.k_mean = K.mean(); e.k_sd = K.sd(); e.k_min = K.min(); e.k_max = K.max();
+		e.w_mean = W.mean(); e.w_sd = W.sd(); e.w_min = W.min(); e.w_max = W.max();
+		e.n_windows = K.size();
+		e.n_underflows = n_underflows;
+		e.busy = busy;
+		e.counters = counters;
+		e.wall = wall;
+		hmms.push_back(e);
+	}
+
+	//One line per stage with counters summed over iterations [IPC, misses per variant x haplotype]
+	std::vector < std::string > summary(double n_cells) {
+		std::vector < std::string > names, lines;
+		std::vector < std::vector < long > > totals;
+		for (int s = 0 ; s < stages.size() ; s ++) {
+			int idx = std::find(names.begin(), names.end(), stages[s].name) - names.begin();
+			if (idx == names.size()) { names.push_back(stages[s].name); totals.push_back(std::vector < long > (PMU_NUMBER, 0)); }
+			for (int c = 0 ; c < PMU_NUMBER ; c ++) totals[idx][c] = (stages[s].counters[c] < 0 || totals[idx][c] < 0)?-1:(totals[idx][c] + stages[s].counters[c]);
+		}
+		for (int n = 0 ; n < names.size() ; n ++) {
+			const long * t = totals[n].data();
+			std::string line = names[n] + " [IPC=" + ((t[PMU_CYCLES] > 0 && t[PMU_INSTRUCTIONS] >= 0)?num(t[PMU_INSTRUCTIONS] * 1.0 / t[PMU_CYCLES]):"NA");
+			line += " / LLC=" + ((t[PMU_LLC_MISSES] >= 0)?num(t[PMU_LLC_MISSES] / n_cells):"NA");
+			line += " / BR=" + ((t[PMU_BRANCH_MISSES] >= 0)?num(t[PMU_BRANCH_MISSES] / n_cells):"NA") + " misses per variant x haplotype]";
+			lines.push_back(line);
+		}
+		return lines;
+	}
+
+	bool write(std::string filename, std::string version, int n_threads, int n_samples, int n_variants, int n_haplotypes, unsigned long peak_rss) {
+		double n_cells = n_variants * 1.0 * n_haplotypes;
+		std::ofstream fd (filename.c_str());
+		if (!fd.good()) return false;
+		string_utils su;
+		fd << "{" << std::endl;
+		fd << "  \"version\": \"" << su.json(version) << "\"," << std::endl;
+		fd << "  \"threads\": " << n_threads << "," << std::endl;
+		fd << "  \"samples\": " << n_samples << "," << std::endl;
+		fd << "  \"variants\": " << n_variants << "," << std::endl;
+		fd << "  \"wall_s\": " << num(std::chrono::duration < double > (std::chrono::steady_clock::now() - start_run).count()) << "," << std::endl;
+		fd << "  \"cpu_s\": " << num((std::clock() - cpu_run) * 1.0 / CLOCKS_PER_SEC) << "," << std::endl;
+		fd << "  \"peak_rss_bytes\": " << peak_rss << "," << std::endl;
+		fd << "  \"stages\": [";
+		for (int s = 0 ; s < stages.size() ; s ++) {
+			fd << (s?",":"") << std::endl << "    {\"name\": \"" << su.json(stages[s].name) << "\"";
+			if (stages[s].iteration >= 0) fd << ", \"iteration\": " << stages[s].iteration + 1 << ", \"type\": \"" << su.json(iteration_types[stages[s].iteration]) << "\"";
+			fd << ", \"wall_s\": " << num(stages[s].wall) << ", \"cpu_s\": " << num(stages[s].cpu);
+			if (countersEnabled()) fd << ", \"counters\": " << counters(stages[s].counters, n_cells);
+			fd << "}";
+		}
+		fd << std::endl << "  ]," << std::endl;
+		fd << "  \"hmm\": [";
+		for (int h = 0 ; h < hmms.size() ; h ++) {
+			fd << (h?",":"") << std::endl << "    {";
+			if (hmms[h].iteration >= 0) fd << "\"iteration\": " << hmms[h].iteration + 1 << ", \"type\": \"" << su.json(iteration_types[hmms[h].iteration]) << "\", ";
+			fd << "\"windows\": " << hmms[h].n_windows << ", \"underflows\": " << hmms[h].n_underflows;
+			fd << ", \"K\": {\"mean\": " << num(hmms[h].k_mean) << ", \"sd\": " << num(hmms[h].k_sd) << ", \"min\": " << num(hmms[h].k_min) << ", \"max\": " << num(hmms[h].k_max) << "}";
+			fd << ", \"W_Mb\": {\"mean\": " << num(hmms[h].w_mean) << ", \"sd\": " << num(hmms[h].w_sd) << ", \"min\": " << num(hmms[h].w_min) << ", \"max\": " << num(hmms[h].w_max) << "}";
+			fd << ", \"threads\": [";
+			for (int t = 0 ; t < hmms[h].busy.size() ; t ++) {
+				fd << (t?", ":"") << "{\"busy_s\": " << num(hmms[h].busy[t]) << ", \"idle_s\": " << num(std::max(0.0, hmms[h].wall - hmms[h].busy[t]));
+				if (t < hmms[h].counters.size()) fd << ", \"counters\": " << counters(hmms[h].counters[t].data(), n_cells);
+				fd << "}";
+			}
+			fd << "]}";
+		}
+		fd << std::endl << "  ]" << std::endl;
+		fd << "}" << std::endl;
+		fd.close();
+		return true;
+	}
+};
+
+#endif
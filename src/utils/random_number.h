@@ -86,6 +86,16 @@ public:
 		return vec.size() - 1;
 	}
 
+	int sample(const double * vec, unsigned int n, double sum) {
+		double csum = vec[0];
+		double u = getDouble() * sum;
+		for (int i = 0; i < n - 1; ++i) {
+			if ( u < csum ) return i;
+			csum += vec[i+1];
+		}
+		return n - 1;
+	}
+
 	int sample4(const double * vec, double sum) {
 		double csum = vec[0];
 		double u = getDouble() * sum;
@@ -58,6 +58,39 @@ public:
 		return true;
     }
 
+	//Escapes quotes, backslashes and control characters for use inside a JSON string
+	std::string json(const std::string & str) {
+		std::ostringstream ss( std::stringstream::out );
+		for (std::string::size_type c = 0 ; c < str.size() ; c ++) {
+			switch (str[c]) {
+			case '"':	ss << "\\\""; break;
+			case '\\':	ss << "\\\\"; break;
+			case '\n':	ss << "\\n"; break;
+			case '\r':	ss << "\\r"; break;
+			case '\t':	ss << "\\t"; break;
+			default:
+				if ((unsigned char)str[c] < 0x20) ss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)(unsigned char)str[c] << std::dec << std::setfill(' ');
+				else ss << str[c];
+			}
+		}
+		return ss.str();
+	}
+
+	//Escapes backslashes, tabs and line breaks for use inside a TSV field
+	std::string tsv(const std::string & str) {
+		std::ostringstream ss( std::stringstream::out );
+		for (std::string::size_type c = 0 ; c < str.size() ; c ++) {
+			switch (str[c]) {
+			case '\\':	ss << "\\\\"; break;
+			case '\n':	ss << "\\n"; break;
+			case '\r':	ss << "\\r"; break;
+			case '\t':	ss << "\\t"; break;
+			default:	ss << str[c];
+			}
+		}
+		return ss.str();
+	}
+
 	template < class T >
 	std::string str(T n, int prec = -1) {
 		std::ostringstream ss( std::stringstream::out );
@@ -0,0 +1,98 @@
+/*******************************************************************************
+ * Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+#ifndef _WORKSPACE_ARENA_H
+#define _WORKSPACE_ARENA_H
+
+#include <cstdlib>
+#include <cassert>
+#include <algorithm>
+#include <cstddef>
+#include <new>
+
+#define WORKSPACE_ALIGN	32
+
+//Scratch memory of a worker thread: grown to the largest request seen, then handed out again for every window
+class workspace_arena {
+protected:
+	unsigned char * buffer;
+	size_t capacity, offset;
+	size_t n_bytes_allocated;
+
+public:
+	workspace_arena() {
+		buffer = NULL;
+		capacity = offset = n_bytes_allocated = 0;
+	}
+
+	//Scratch content is never shared: copies start empty
+	workspace_arena(const workspace_arena & a) {
+		buffer = NULL;
+		capacity = offset = n_bytes_allocated = 0;
+	}
+
+	workspace_arena & operator = (const workspace_arena & a) {
+		return *this;
+	}
+
+	~workspace_arena() {
+		clear();
+	}
+
+	//Bytes needed to hold n elements of type T, padded to keep the next block aligned
+	template < class T >
+	static size_t footprint(size_t n) {
+		return ((n * sizeof(T) + WORKSPACE_ALIGN - 1) / WORKSPACE_ALIGN) * WORKSPACE_ALIGN;
+	}
+
+	//Discards all previous blocks and makes sure that the next 'bytes' can be taken without reallocation
+	void reset(size_t bytes) {
+		offset = 0;
+		if (bytes <= capacity) return;
+		size_t new_capacity = std::max(bytes, capacity + capacity / 2);
+		void * ptr = NULL;
+		std::free(buffer);
+		if (posix_memalign(&ptr, WORKSPACE_ALIGN, new_capacity)) throw std::bad_alloc();
+		buffer = (unsigned char *)ptr;
+		capacity = new_capacity;
+		n_bytes_allocated += new_capacity;
+	}
+
+	template < class T >
+	T * take(size_t n) {
+		T * ptr = (T *)(buffer + offset);
+		offset += footprint < T > (n);
+		assert(offset <= capacity);
+		return ptr;
+	}
+
+	void clear() {
+		std::free(buffer);
+		buffer = NULL;
+		capacity = offset = 0;
+	}
+
+	size_t size() const { return capacity; }
+	size_t allocated() const { return n_bytes_allocated; }
+	void resetAllocated() { n_bytes_allocated = 0; }
+};
+
+#endif
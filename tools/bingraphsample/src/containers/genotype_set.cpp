@@ -21,7 +21,9 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include <containers/genotype_set.h>
 
-void * collapse_callback(void * ptr) {
+#include <sys/mman.h>
+
+void * process_callback(void * ptr) {
 	genotype_set * S = static_cast< genotype_set * >( ptr );
 	int id_worker, id_job;
 	pthread_mutex_lock(&S->mutex_workers);
@@ -30,61 +32,88 @@ void * collapse_callback(void * ptr) {
 	for(;;) {
 		pthread_mutex_lock(&S->mutex_workers);
 		id_job = S->i_jobs ++;
-		if (id_job < S->vecG.size()) vrb.bullet("Sample [" + stb.str(id_job+1) + "/" + stb.str(S->vecG.size()) + "]");
+		if (id_job < S->vecG.size() && S->mode == SET_COLLAPSE) vrb.bullet("Sample [" + stb.str(id_job+1) + "/" + stb.str(S->vecG.size()) + "]");
 		pthread_mutex_unlock(&S->mutex_workers);
-		if (id_job < S->vecG.size()) {
-			for (int n = 0 ; n < S->Nrep ; n++) {
-				S->vecG[id_job]->sample();
-				S->vecG[id_job]->storeCollapse();
-			}
-		} else pthread_exit(NULL);
+		if (id_job < S->vecG.size()) S->process(id_job);
+		else pthread_exit(NULL);
 	}
 }
 
 genotype_set::genotype_set() {
 	n_site = 0;
 	n_ind = 0;
+	Nrep = 0;
+	mode = SET_SAMPLE;
+	seed = 15052011;
+	mapped_bytes = NULL;
+	mapped_size = 0;
 }
 
 genotype_set::~genotype_set() {
 	for (int i = 0 ; i< vecG.size() ; i ++) delete vecG[i];
 	vecG.clear();
+	if (mapped_bytes) munmap(mapped_bytes, mapped_size);
+	mapped_bytes = NULL;
+	mapped_size = 0;
 	n_site = 0;
 	n_ind = 0;
 }
 
-void genotype_set::init() {
+void genotype_set::init(int n_draws) {
 	tac.clock();
-	for (int i = 0 ; i < vecG.size() ; i ++) vecG[i]->init();
+	for (int i = 0 ; i < vecG.size() ; i ++) vecG[i]->init(n_draws);
 	vrb.bullet("HAP initializing (" + stb.str(tac.rel_time()*1.0/1000, 2) + "s)");
 }
 
-void genotype_set::solve() {
-	tac.clock();
-	for (int i = 0 ; i < vecG.size() ; i ++) vecG[i]->solve();
-	vrb.bullet("HAP solving (" + stb.str(tac.rel_time()*1.0/1000, 2) + "s)");
+void genotype_set::process(int i) {
+	//Random stream keyed on sample index: same draws whatever the number of threads
+	counter_rng R (seed, vecG[i]->index);
+	switch (mode) {
+	case SET_SAMPLE:	vecG[i]->sample(R); break;
+	case SET_SOLVE:		vecG[i]->solve(); break;
+	case SET_COLLAPSE:	for (int n = 0 ; n < Nrep ; n++) {
+							vecG[i]->sample(R);
+							vecG[i]->storeCollapse();
+						}
+						break;
+	case SET_DRAWS:		vecG[i]->draws(Nrep, R); break;
+	}
 }
 
+void genotype_set::run(int _mode, int T) {
+	mode = _mode;
+	i_workers = 0; i_jobs = 0;
+	if (T > 1) {
+		for (int t = 0 ; t < T ; t++) pthread_create( &id_workers[t] , NULL, process_callback, static_cast<void *>(this));
+		for (int t = 0 ; t < T ; t++) pthread_join( id_workers[t] , NULL);
+	} else for (int i = 0 ; i < vecG.size() ; i ++) {
+		process(i);
+		if (mode == SET_COLLAPSE) vrb.bullet("Sample [" + stb.str(i+1) + "/" + stb.str(vecG.size()) + "]");
+	}
+}
 
-void genotype_set::sample() {
+void genotype_set::solve(int T) {
 	tac.clock();
-	for (int i = 0 ; i < vecG.size() ; i ++) vecG[i]->sample();
-	vrb.bullet("HAP sampling (" + stb.str(tac.rel_time()*1.0/1000, 2) + "s)");
+	run(SET_SOLVE, T);
+	vrb.bullet("HAP solving [T=" + stb.str(T) + "] (" + stb.str(tac.rel_time()*1.0/1000, 2) + "s)");
+}
+
+void genotype_set::sample(int T) {
+	tac.clock();
+	run(SET_SAMPLE, T);
+	vrb.bullet("HAP sampling [T=" + stb.str(T) + "] (" + stb.str(tac.rel_time()*1.0/1000, 2) + "s)");
 }
 
 void genotype_set::collapse(int N, int T) {
 	tac.clock();
 	Nrep = N;
-	i_workers = 0; i_jobs = 0;
-	if (T > 1) {
-		for (int t = 0 ; t < T ; t++) pthread_create( &id_workers[t] , NULL, collapse_callback, static_cast<void *>(this));
-		for (int t = 0 ; t < T ; t++) pthread_join( id_workers[t] , NULL);
-	} else for (int i = 0 ; i < vecG.size() ; i ++) {
-		for (int n = 0 ; n < Nrep ; n++) {
-			vecG[i]->sample();
-			vecG[i]->storeCollapse();
-		}
-		vrb.bullet("Sample [" + stb.str(i+1) + "/" + stb.str(vecG.size()) + "]");
-	}
+	run(SET_COLLAPSE, T);
 	vrb.bullet("HAP collapsing (" + stb.str(tac.rel_time()*1.0/1000, 2) + "s)");
 }
+
+void genotype_set::draws(int N, int T) {
+	tac.clock();
+	Nrep = N;
+	run(SET_DRAWS, T);
+	vrb.bullet("HAP drawing [N=" + stb.str(N) + " / T=" + stb.str(T) + "] (" + stb.str(tac.rel_time()*1.0/1000, 2) + "s)");
+}
@@ -27,13 +27,23 @@
 #include <objects/genotype/genotype_header.h>
 #include <containers/variant_map.h>
 
+#define SET_SAMPLE		0
+#define SET_SOLVE		1
+#define SET_COLLAPSE	2
+#define SET_DRAWS		3
+
 class genotype_set {
 public:
 	//DATA
 	int n_site, n_ind;					//Number of variants, number of individuals
-	int Nrep;
+	int Nrep, mode;
+	unsigned int seed;					//Seed of the per-sample random streams
 	vector < genotype * > vecG;			//Vector of genotype graphs
 
+	//MEMORY MAPPED BIN FILE (genotype graphs may view into it)
+	unsigned char * mapped_bytes;
+	size_t mapped_size;
+
 	//MULTI-THREADING
 	int i_workers, i_jobs;
 	vector < pthread_t > id_workers;
@@ -45,10 +55,13 @@ public:
 	genotype_set();
 	~genotype_set();
 
-	void init();
-	void solve();
-	void sample();
+	void init(int n_draws = 1);
+	void process(int);
+	void run(int, int);
+	void solve(int);
+	void sample(int);
 	void collapse(int, int);
+	void draws(int, int);
 };
 
 #endif
@@ -21,24 +21,34 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include <io/graph_reader.h>
 
+#include <zlib.h>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
 graph_reader::graph_reader(genotype_set & _G, variant_map & _V): G(_G), V(_V) {
+	mapped_bytes = NULL;
+	mapped_size = 0;
+	mapped_viewed = false;
+	prob_bits = 32;
 }
 
 graph_reader::~graph_reader() {
+	if (mapped_bytes && !mapped_viewed) munmap(mapped_bytes, mapped_size);
+	mapped_bytes = NULL;
+	mapped_size = 0;
 }
 
-void graph_reader::binary_read(input_file & fin, vector < bool > & x) {
-	vector < bool >::size_type n;
-	fin.read((char*)&n, sizeof(vector<bool>::size_type));
-	x.resize(n);
-    for(vector<bool>::size_type i = 0; i < n;) {
-    	unsigned char aggr;
-        fin.read((char*)&aggr, sizeof(unsigned char));
-        for(unsigned char mask = 1; mask > 0 && i < n; ++i, mask <<= 1) x.at(i) = aggr & mask;
-	}
+void graph_reader::binary_read(istream & fin, buffer_view < unsigned char > & x) {
+	size_t n;
+	fin.read((char*)&n, sizeof(size_t));
+	x.allocate((n+7)/8);
+	fin.read((char*)x.data(), x.size());
 }
 
-void graph_reader::string_read(input_file & fin, string & x) {
+void graph_reader::string_read(istream & fin, string & x) {
 	size_t str_len;
 	fin.read((char*)&str_len, sizeof(size_t));
 	char * temp = new char[str_len+1];
@@ -48,64 +58,265 @@ void graph_reader::string_read(input_file & fin, string & x) {
 	delete [] temp;
 }
 
-void graph_reader::readGraphs(string fname) {
-	// Init
-	tac.clock();
-	input_file fd (fname);
+//Block header [usize|csize] and payload must lie within the mapping [checked without overflowing on corrupt values]
+void graph_reader::block_check(unsigned long offset, unsigned long & usize, unsigned long & csize) {
+	if (offset > mapped_size || mapped_size - offset < 2 * sizeof(unsigned long)) vrb.error("Truncated BIN block at offset [" + stb.str(offset) + "]");
+	memcpy(&usize, mapped_bytes + offset, sizeof(usize));
+	memcpy(&csize, mapped_bytes + offset + sizeof(usize), sizeof(csize));
+	if ((csize?csize:usize) > mapped_size - offset - 2 * sizeof(unsigned long)) vrb.error("Truncated BIN block at offset [" + stb.str(offset) + "]");
+}
 
-	//Read variant map
+//Field of n bytes starting at pos must lie within a viewed record of rec_size bytes
+void graph_reader::view_check(size_t pos, size_t n, size_t rec_size, unsigned long offset) {
+	if (pos > rec_size || n > rec_size - pos) vrb.error("Corrupted BIN record at offset [" + stb.str(offset) + "]");
+}
+
+bool graph_reader::block_read(unsigned long offset, string & x) {
+	unsigned long usize, csize;
+	block_check(offset, usize, csize);
+	unsigned char * zbuffer = mapped_bytes + offset + 2 * sizeof(unsigned long);
+
+	//Uncompressed block [csize=0]: copy it out, caller may prefer viewing it in place
+	if (!csize) {
+		x.assign(reinterpret_cast<char*>(zbuffer), usize);
+		return false;
+	}
+	x.resize(usize);
+	uLongf zsize = usize;
+	if (uncompress(reinterpret_cast<Bytef*>(&x[0]), &zsize, zbuffer, csize) != Z_OK || zsize != usize) vrb.error("Corrupted BIN block at offset [" + stb.str(offset) + "]");
+	return true;
+}
+
+void graph_reader::variant_read(istream & fin) {
 	int n_variants;
-	fd.read((char*)&n_variants, sizeof(int));
+	fin.read((char*)&n_variants, sizeof(int));
 	for (int l = 0 ; l < n_variants ; l ++) {
 		variant * v = new variant();
-		string_read(fd, v->chr);
-		fd.read(reinterpret_cast<char*>(&v->bp), sizeof(v->bp));
-		string_read(fd, v->id);
-		string_read(fd, v->ref);
-		string_read(fd, v->alt);
-		fd.read(reinterpret_cast<char*>(&v->idx), sizeof(v->idx));
+		string_read(fin, v->chr);
+		fin.read(reinterpret_cast<char*>(&v->bp), sizeof(v->bp));
+		string_read(fin, v->id);
+		string_read(fin, v->ref);
+		string_read(fin, v->alt);
+		fin.read(reinterpret_cast<char*>(&v->idx), sizeof(v->idx));
 		V.push(v);
 	}
 	G.n_site = V.size();
+}
+
+void graph_reader::genotype_read(istream & fin, genotype * g) {
+	// name
+	string_read(fin, g->name);
+
+	// integers
+	fin.read(reinterpret_cast<char*>(&g->index), sizeof(g->index));
+	fin.read(reinterpret_cast<char*>(&g->n_segments), sizeof(g->n_segments));
+	fin.read(reinterpret_cast<char*>(&g->n_variants), sizeof(g->n_variants));
+	fin.read(reinterpret_cast<char*>(&g->n_ambiguous), sizeof(g->n_ambiguous));
+	fin.read(reinterpret_cast<char*>(&g->n_missing), sizeof(g->n_missing));
+	fin.read(reinterpret_cast<char*>(&g->n_transitions), sizeof(g->n_transitions));
+	fin.read(reinterpret_cast<char*>(&g->n_stored_transitionProbs), sizeof(g->n_stored_transitionProbs));
+	fin.read(reinterpret_cast<char*>(&g->n_storage_events), sizeof(g->n_storage_events));
+
+	// allocation
+	g->Variants.allocate(DIV2(G.n_site) + MOD2(G.n_site));
+	g->Ambiguous.allocate(g->n_ambiguous);
+	g->Diplotypes.allocate(g->n_segments);
+	g->Lengths.allocate(g->n_segments);
+	g->ProbStored.allocate(g->n_stored_transitionProbs);
+	g->ProbMissing.allocate(g->n_missing * HAP_NUMBER);
+
+	// vectors
+	fin.read(reinterpret_cast<char*>(g->Variants.data()), g->Variants.size());
+	fin.read(reinterpret_cast<char*>(g->Ambiguous.data()), g->Ambiguous.size());
+	fin.read(reinterpret_cast<char*>(g->Diplotypes.data()), g->Diplotypes.size() * sizeof(unsigned long));
+	fin.read(reinterpret_cast<char*>(g->Lengths.data()), g->Lengths.size() * sizeof(unsigned short));
+	binary_read(fin, g->ProbMask);
+	if (prob_bits == 32) {
+		fin.read(reinterpret_cast<char*>(g->ProbStored.data()), g->ProbStored.size() * sizeof(float));
+		fin.read(reinterpret_cast<char*>(g->ProbMissing.data()), g->ProbMissing.size() * sizeof(float));
+	} else {
+		vector < unsigned char > stored = vector < unsigned char > (g->ProbStored.size() * (prob_bits / 8));
+		vector < unsigned char > missing = vector < unsigned char > (g->ProbMissing.size() * (prob_bits / 8));
+		fin.read(reinterpret_cast<char*>(stored.data()), stored.size());
+		fin.read(reinterpret_cast<char*>(missing.data()), missing.size());
+		prob_dequantize(stored.data(), missing.data(), g);
+	}
+}
+
+void graph_reader::prob_dequantize(const unsigned char * stored, const unsigned char * missing, genotype * g) {
+	unsigned int qmax = (1U << prob_bits) - 1;
+	unsigned short q16;
+	g->ProbStored.allocate(g->n_stored_transitionProbs);
+	g->ProbMissing.allocate(g->n_missing * HAP_NUMBER);
+	for (unsigned int t = 0 ; t < g->ProbStored.size() ; t ++) {
+		if (prob_bits == 16) memcpy(&q16, stored + 2 * t, sizeof(q16));
+		g->ProbStored[t] = dequantizeTransition((prob_bits == 8)?stored[t]:q16, g->n_storage_events, qmax);
+	}
+	for (unsigned int m = 0 ; m < g->ProbMissing.size() ; m ++) {
+		if (prob_bits == 16) memcpy(&q16, missing + 2 * m, sizeof(q16));
+		g->ProbMissing[m] = dequantizeMissing((prob_bits == 8)?missing[m]:q16, g->n_storage_events, qmax);
+	}
+}
+
+void graph_reader::genotype_view(unsigned long offset, genotype * g) {
+	unsigned long rec_size, csize;
+	block_check(offset, rec_size, csize);
+	unsigned char * rec = mapped_bytes + offset + 2 * sizeof(unsigned long);
+	size_t pos = 0, str_len, n_mask, n_bytes;
+
+	// name
+	view_check(pos, sizeof(size_t), rec_size, offset); memcpy(&str_len, rec + pos, sizeof(size_t)); pos += sizeof(size_t);
+	view_check(pos, str_len, rec_size, offset); g->name = string(reinterpret_cast<char*>(rec + pos), str_len); pos += str_len;
+
+	// integers
+	unsigned int * fields [8] = { &g->index, &g->n_segments, &g->n_variants, &g->n_ambiguous, &g->n_missing, &g->n_transitions, &g->n_stored_transitionProbs, &g->n_storage_events };
+	view_check(pos, 8 * sizeof(unsigned int), rec_size, offset);
+	for (int f = 0 ; f < 8 ; f ++, pos += sizeof(unsigned int)) memcpy(fields[f], rec + pos, sizeof(unsigned int));
+
+	// vectors viewed in place [each one starts on an 8 bytes boundary]
+	n_bytes = DIV2(G.n_site) + MOD2(G.n_site);
+	pos = BINGRAPH_ALIGN(pos); view_check(pos, n_bytes, rec_size, offset); g->Variants.view(rec + pos, n_bytes); pos += n_bytes;
+	n_bytes = g->n_ambiguous;
+	pos = BINGRAPH_ALIGN(pos); view_check(pos, n_bytes, rec_size, offset); g->Ambiguous.view(rec + pos, n_bytes); pos += n_bytes;
+	n_bytes = g->n_segments * sizeof(unsigned long);
+	pos = BINGRAPH_ALIGN(pos); view_check(pos, n_bytes, rec_size, offset); g->Diplotypes.view(reinterpret_cast<unsigned long*>(rec + pos), g->n_segments); pos += n_bytes;
+	n_bytes = g->n_segments * sizeof(unsigned short);
+	pos = BINGRAPH_ALIGN(pos); view_check(pos, n_bytes, rec_size, offset); g->Lengths.view(reinterpret_cast<unsigned short*>(rec + pos), g->n_segments); pos += n_bytes;
+	pos = BINGRAPH_ALIGN(pos); view_check(pos, sizeof(size_t), rec_size, offset); memcpy(&n_mask, rec + pos, sizeof(size_t)); pos += sizeof(size_t);
+	n_bytes = n_mask / 8 + (n_mask % 8 != 0);
+	view_check(pos, n_bytes, rec_size, offset); g->ProbMask.view(rec + pos, n_bytes); pos += n_bytes;
+	size_t n_bytes_stored = g->n_stored_transitionProbs * (size_t)(prob_bits / 8);
+	size_t n_bytes_missing = g->n_missing * (size_t)HAP_NUMBER * (prob_bits / 8);
+	size_t pos_stored = BINGRAPH_ALIGN(pos);
+	view_check(pos_stored, n_bytes_stored, rec_size, offset);
+	size_t pos_missing = BINGRAPH_ALIGN(pos_stored + n_bytes_stored);
+	view_check(pos_missing, n_bytes_missing, rec_size, offset);
+	if (prob_bits == 32) {
+		g->ProbStored.view(reinterpret_cast<float*>(rec + pos_stored), g->n_stored_transitionProbs);
+		g->ProbMissing.view(reinterpret_cast<float*>(rec + pos_missing), g->n_missing * HAP_NUMBER);
+	} else {
+		//Quantized probabilities cannot be viewed in place, they are expanded back to floats
+		prob_dequantize(rec + pos_stored, rec + pos_missing, g);
+	}
+}
+
+bool graph_reader::openIndex(string fname) {
+	unsigned int version;
+	unsigned long index_offset;
+	string buffer;
+
+	//Map the whole file in memory
+	int fd = open(fname.c_str(), O_RDONLY);
+	if (fd < 0) vrb.error("Impossible to open BIN file [" + fname + "]");
+	struct stat st;
+	if (fstat(fd, &st) < 0) vrb.error("Impossible to stat BIN file [" + fname + "]");
+	mapped_size = st.st_size;
+	if (mapped_size < 2 * (8 + sizeof(unsigned long))) { close(fd); mapped_size = 0; return false; }
+	void * addr = mmap(NULL, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (addr == MAP_FAILED) vrb.error("Impossible to map BIN file [" + fname + "]");
+	mapped_bytes = static_cast < unsigned char * > (addr);
+
+	//Check header and footer magic
+	if (memcmp(mapped_bytes, BINGRAPH_MAGIC, 8)) {
+		munmap(mapped_bytes, mapped_size);
+		mapped_bytes = NULL;
+		mapped_size = 0;
+		return false;
+	}
+	memcpy(&version, mapped_bytes + 8, sizeof(version));
+	if (version != 2 && version != BINGRAPH_VERSION) vrb.error("Unsupported BIN version [" + stb.str(version) + "]");
+	if (version >= 3) memcpy(&prob_bits, mapped_bytes + 8 + sizeof(version), sizeof(prob_bits));
+	if (prob_bits != 32 && prob_bits != 16 && prob_bits != 8) vrb.error("Unsupported BIN probability precision [" + stb.str(prob_bits) + " bits]");
+	if (memcmp(mapped_bytes + mapped_size - 8, BINGRAPH_MAGIC, 8)) vrb.error("BIN file is truncated, index is missing [" + fname + "]");
+	memcpy(&index_offset, mapped_bytes + mapped_size - 8 - sizeof(index_offset), sizeof(index_offset));
+
+	//Read variant map
+	unsigned long header_offset = 8 + sizeof(version) + ((version >= 3)?sizeof(prob_bits):0);
+	if (index_offset < header_offset || index_offset > mapped_size - 8 - sizeof(index_offset)) vrb.error("Corrupted BIN index offset [" + stb.str(index_offset) + "]");
+	block_read(header_offset, buffer);
+	istringstream hdr (buffer);
+	variant_read(hdr);
+
+	//Read sample index
+	int n_samples;
+	block_read(index_offset, buffer);
+	istringstream idx (buffer);
+	idx.read(reinterpret_cast<char*>(&n_samples), sizeof(n_samples));
+	if (!idx.good() || n_samples < 0) vrb.error("Corrupted BIN index, invalid number of samples");
+	index_names = vector < string > (n_samples);
+	index_offsets = vector < unsigned long > (n_samples, 0);
+	for (int i  = 0 ; i < n_samples ; i++) {
+		string_read(idx, index_names[i]);
+		idx.read(reinterpret_cast<char*>(&index_offsets[i]), sizeof(index_offsets[i]));
+		if (!idx.good()) vrb.error("Corrupted BIN index, truncated at sample [" + stb.str(i) + "]");
+		//Sample blocks lie between the variant map and the index
+		unsigned long usize, csize;
+		if (index_offsets[i] <= header_offset || index_offsets[i] >= index_offset) vrb.error("Corrupted BIN index, offset of sample [" + index_names[i] + "] is out of range");
+		block_check(index_offsets[i], usize, csize);
+		if (index_offset - index_offsets[i] < 2 * sizeof(unsigned long) || (csize?csize:usize) > index_offset - index_offsets[i] - 2 * sizeof(unsigned long)) vrb.error("Corrupted BIN index, block of sample [" + index_names[i] + "] overlaps the index");
+	}
+	return true;
+}
+
+genotype * graph_reader::readGraph(unsigned int i) {
+	unsigned long usize, csize;
+	genotype * g = new genotype(G.vecG.size());
+	block_check(index_offsets[i], usize, csize);
+	if (!csize) {
+		//Zero-copy: genotype arrays point directly into the mapped file
+		genotype_view(index_offsets[i], g);
+		mapped_viewed = true;
+	} else {
+		string buffer;
+		block_read(index_offsets[i], buffer);
+		istringstream rec (buffer);
+		genotype_read(rec, g);
+	}
+	return g;
+}
+
+void graph_reader::readGraphs(string fname, set < string > & subset) {
+	// Init
+	tac.clock();
+	if (!openIndex(fname)) {
+		if (subset.size()) vrb.error("Sample subsetting requires an indexed BIN file");
+		return readGraphsLegacy(fname);
+	}
+
+	//Random access to the requested genotype graphs
+	for (int i  = 0 ; i < index_names.size() ; i++) {
+		if (subset.size() && !subset.count(index_names[i])) continue;
+		G.vecG.push_back(readGraph(i));
+		G.n_ind ++;
+	}
+	if (mapped_viewed) {
+		G.mapped_bytes = mapped_bytes;
+		G.mapped_size = mapped_size;
+	}
+	if (subset.size() && G.n_ind != subset.size()) vrb.warning("Only [" + stb.str(G.n_ind) + "/" + stb.str(subset.size()) + "] requested samples found in BIN file");
+	vrb.bullet("BIN reading [" + string(mapped_viewed?"Mapped":"Indexed") + " / N=" + stb.str(G.n_ind) + "/" + stb.str(index_names.size()) + " / L=" + stb.str(V.size()) + " / bits=" + stb.str(prob_bits) + "] (" + stb.str(tac.rel_time()*0.001, 2) + "s)");
+}
+
+void graph_reader::readGraphs(string fname) {
+	set < string > subset;
+	readGraphs(fname, subset);
+}
+
+void graph_reader::readGraphsLegacy(string fname) {
+	// Init
+	tac.clock();
+	input_file fd (fname);
+
+	//Read variant map
+	variant_read(fd);
 
 	//Read genotype graphs
 	int n_samples;
 	fd.read((char*)&n_samples, sizeof(int));
 	for (int i  = 0 ; i < n_samples ; i++) {
 		genotype * g = new genotype(i);
-
-		// name
-		string_read(fd, g->name);
-
-		// integers
-		fd.read(reinterpret_cast<char*>(&g->index), sizeof(g->index));
-		fd.read(reinterpret_cast<char*>(&g->n_segments), sizeof(g->n_segments));
-		fd.read(reinterpret_cast<char*>(&g->n_variants), sizeof(g->n_variants));
-		fd.read(reinterpret_cast<char*>(&g->n_ambiguous), sizeof(g->n_ambiguous));
-		fd.read(reinterpret_cast<char*>(&g->n_missing), sizeof(g->n_missing));
-		fd.read(reinterpret_cast<char*>(&g->n_transitions), sizeof(g->n_transitions));
-		fd.read(reinterpret_cast<char*>(&g->n_stored_transitionProbs), sizeof(g->n_stored_transitionProbs));
-		fd.read(reinterpret_cast<char*>(&g->n_storage_events), sizeof(g->n_storage_events));
-		//cout << g->index << "\t" << g->n_segments << "\t" << g->n_variants<< "\t" << g->n_ambiguous<< "\t" << g->n_missing << "\t" << g->n_transitions << "\t" << g->n_stored_transitionProbs << "\t" << g->n_storage_events<< endl;
-
-		// allocation
-		g->Variants = vector < unsigned char > (DIV2(n_variants) + MOD2(n_variants), 0);
-		g->Ambiguous = vector < unsigned char > (g->n_ambiguous,0);
-		g->Diplotypes = vector < unsigned long > (g->n_segments, 0);
-		g->Lengths = vector < unsigned short > (g->n_segments, 0);
-		g->ProbStored = vector < float > (g->n_stored_transitionProbs, 0.0f);
-		g->ProbMissing = vector < float > (g->n_missing * HAP_NUMBER, 0.0f);
-
-		// vectors
-		fd.read(reinterpret_cast<char*>(&g->Variants[0]), g->Variants.size());
-		fd.read(reinterpret_cast<char*>(&g->Ambiguous[0]), g->Ambiguous.size());
-		fd.read(reinterpret_cast<char*>(&g->Diplotypes[0]), g->Diplotypes.size() * sizeof(unsigned long));
-		fd.read(reinterpret_cast<char*>(&g->Lengths[0]), g->Lengths.size() * sizeof(unsigned short));
-		binary_read(fd, g->ProbMask);
-		fd.read(reinterpret_cast<char*>(&g->ProbStored[0]), g->ProbStored.size() * sizeof(float));
-		fd.read(reinterpret_cast<char*>(&g->ProbMissing[0]), g->ProbMissing.size() * sizeof(float));
-
-		//
+		genotype_read(fd, g);
 		G.vecG.push_back(g);
 		G.n_ind ++;
 	}
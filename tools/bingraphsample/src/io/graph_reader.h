@@ -27,23 +27,46 @@
 #include <containers/variant_map.h>
 #include <containers/genotype_set.h>
 
+//Indexed BIN layout: [magic|version|prob bits] [variant map block] [sample blocks ...] [index block] [index offset|magic]
+#define BINGRAPH_MAGIC		"SHP4GRPH"
+#define BINGRAPH_VERSION	3
+#define BINGRAPH_ALIGN(x)	(((x)+7UL)&~7UL)
+
 class graph_reader {
 public:
 	//DATA
 	genotype_set & G;
 	variant_map & V;
 
+	//INDEX
+	unsigned char * mapped_bytes;
+	size_t mapped_size;
+	bool mapped_viewed;
+	unsigned int prob_bits;
+	vector < string > index_names;
+	vector < unsigned long > index_offsets;
+
 	//CONSTRUCTORS/DESCTRUCTORS
 	graph_reader(genotype_set &, variant_map &);
 	~graph_reader();
 
 	//ROUTINES
-	void binary_read(input_file & fout, std::vector<bool> & x);
-	void string_read(input_file & fin, string & x);
-
+	void binary_read(istream & fin, buffer_view < unsigned char > & x);
+	void string_read(istream & fin, string & x);
+	void block_check(unsigned long offset, unsigned long & usize, unsigned long & csize);
+	void view_check(size_t pos, size_t n, size_t rec_size, unsigned long offset);
+	bool block_read(unsigned long offset, string & x);
+	void variant_read(istream & fin);
+	void genotype_read(istream & fin, genotype * g);
+	void genotype_view(unsigned long offset, genotype * g);
+	void prob_dequantize(const unsigned char * stored, const unsigned char * missing, genotype * g);
 
 	//IO
+	bool openIndex(string finput);
+	genotype * readGraph(unsigned int i);
+	void readGraphs(string finput, set < string > & subset);
 	void readGraphs(string finput);
+	void readGraphsLegacy(string finput);
 };
 
 #endif
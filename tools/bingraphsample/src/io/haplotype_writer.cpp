@@ -28,18 +28,97 @@
 #define MODE_SPL	0
 #define MODE_SOL	1
 #define MODE_COL	2
+#define MODE_DRW	3
 
+#define BLOCK_SIZE	1024
 
+//Persistent workers: wait for a block to be released, fill its records, then wait for the next one
+void * fill_callback(void * ptr) {
+	haplotype_writer * S = static_cast< haplotype_writer * >( ptr );
+	int id_job;
+	pthread_mutex_lock(&S->mutex_workers);
+	for(;;) {
+		while (!S->done_jobs && S->i_jobs >= S->end_jobs) pthread_cond_wait(&S->cond_jobs, &S->mutex_workers);
+		if (S->i_jobs >= S->end_jobs) break;
+		id_job = S->i_jobs ++;
+		pthread_mutex_unlock(&S->mutex_workers);
+		S->fillRecord(id_job);
+		pthread_mutex_lock(&S->mutex_workers);
+		if (++ S->n_filled == S->end_jobs) pthread_cond_signal(&S->cond_filled);
+	}
+	pthread_mutex_unlock(&S->mutex_workers);
+	pthread_exit(NULL);
+}
 
 haplotype_writer::haplotype_writer(genotype_set & _G, variant_map & _V): G(_G), V(_V) {
+	mode = MODE_SPL;
+	n_draws = 1;
+	i_jobs = end_jobs = n_filled = 0;
+	done_jobs = false;
 }
 
 haplotype_writer::~haplotype_writer() {
 }
 
-void haplotype_writer::writeHaplotypes(string fname, int mode, int seed) {
+void haplotype_writer::fillRecord(int l) {
+	int lrel = l % (2 * BLOCK_SIZE);
+	if (mode != MODE_COL) {
+		int * genotypes = &block_genotypes[lrel * 2 * G.n_ind * n_draws];
+		int count_alt = 0;
+		for (int i = 0, c = 0 ; i < G.n_ind ; i++) {
+			for (int d = 0 ; d < n_draws ; d ++, c ++) {
+				bool a0 = G.vecG[i]->H0[d * G.vecG[i]->n_variants + l];
+				bool a1 = G.vecG[i]->H1[d * G.vecG[i]->n_variants + l];
+				count_alt += a0+a1;
+				genotypes[2*c+0] = bcf_gt_phased(a0);
+				genotypes[2*c+1] = bcf_gt_phased(a1);
+			}
+		}
+		block_counts[lrel] = count_alt;
+		block_freqs[lrel] = count_alt * 1.0 / (2 * G.n_ind * n_draws);
+	} else {
+		float * posteriors = &block_posteriors[lrel * 4 * G.n_ind];
+		float count_alt = 0;
+		for (int i = 0 ; i < G.n_ind ; i++) {
+			float rr = G.vecG[i]->Collapsed[4*l+0];
+			float ra = G.vecG[i]->Collapsed[4*l+1];
+			float ar = G.vecG[i]->Collapsed[4*l+2];
+			float aa = G.vecG[i]->Collapsed[4*l+3];
+			float scale = 1.0/(rr+ra+ar+aa);
+			rr *= scale;
+			ra *= scale;
+			ar *= scale;
+			aa *= scale;
+			count_alt += ra+ar+2.0*aa;
+			posteriors[4*i+0] = rr;
+			posteriors[4*i+1] = ra;
+			posteriors[4*i+2] = ar;
+			posteriors[4*i+3] = aa;
+		}
+		block_counts[lrel] = (int)count_alt;
+		block_freqs[lrel] = count_alt * 1.0 / (2 * G.n_ind);
+	}
+}
+
+//Releases the records [.., end) to the workers
+void haplotype_writer::releaseBlock(int end) {
+	pthread_mutex_lock(&mutex_workers);
+	end_jobs = end;
+	pthread_cond_broadcast(&cond_jobs);
+	pthread_mutex_unlock(&mutex_workers);
+}
+
+//Waits until the workers filled all records before end
+void haplotype_writer::waitBlock(int end) {
+	pthread_mutex_lock(&mutex_workers);
+	while (n_filled < end) pthread_cond_wait(&cond_filled, &mutex_workers);
+	pthread_mutex_unlock(&mutex_workers);
+}
+
+void haplotype_writer::writeHaplotypes(string fname, int _mode, int seed, int T, int _n_draws) {
 	// Init
 	tac.clock();
+	mode = _mode;
 	string file_format = "w";
 	unsigned int file_type = OFILE_VCFU;
 	if (fname.size() > 6 && fname.substr(fname.size()-6) == "vcf.gz") { file_format = "wz"; file_type = OFILE_VCFC; }
@@ -55,6 +134,7 @@ void haplotype_writer::writeHaplotypes(string fname, int mode, int seed) {
 	case MODE_SPL:	str_mode = "##source=shapeit4-sample-" + stb.str(seed); break;
 	case MODE_SOL:	str_mode = "##source=shapeit4-best_guess"; break;
 	case MODE_COL:	str_mode = "##source=shapeit4-collapse"; break;
+	case MODE_DRW:	str_mode = "##source=shapeit4-draws-" + stb.str(_n_draws) + "-" + stb.str(seed); break;
 	}
 	bcf_hdr_append(hdr, str_mode.c_str());
 	bcf_hdr_append(hdr, string("##contig=<ID="+ V.vec_pos[0]->chr + ">").c_str());
@@ -65,82 +145,73 @@ void haplotype_writer::writeHaplotypes(string fname, int mode, int seed) {
 		case MODE_SPL:	bcf_hdr_append(hdr, "##FORMAT=<ID=GT,Number=1,Type=String,Description=\"Phased genotypes\">"); break;
 		case MODE_SOL:	bcf_hdr_append(hdr, "##FORMAT=<ID=GT,Number=1,Type=String,Description=\"Phased genotypes\">"); break;
 		case MODE_COL:	bcf_hdr_append(hdr, "##FORMAT=<ID=PO,Number=4,Type=Float,Description=\"Phased genotypes\">"); break;
+		case MODE_DRW:	bcf_hdr_append(hdr, "##FORMAT=<ID=GT,Number=1,Type=String,Description=\"Phased genotypes [one column per draw, named SAMPLE_DRAW]\">"); break;
 	}
 
 	//Add samples
-	for (int i = 0 ; i < G.n_ind ; i ++) bcf_hdr_add_sample(hdr, G.vecG[i]->name.c_str());
+	n_draws = (mode == MODE_DRW)?_n_draws:1;
+	for (int i = 0 ; i < G.n_ind ; i ++) {
+		if (mode != MODE_DRW) bcf_hdr_add_sample(hdr, G.vecG[i]->name.c_str());
+		else for (int d = 0 ; d < n_draws ; d ++) bcf_hdr_add_sample(hdr, string(G.vecG[i]->name + "_" + stb.str(d+1)).c_str());
+	}
 	bcf_hdr_add_sample(hdr, NULL);      // to update internal structures
 	bcf_hdr_write(fp, hdr);
 
-	//Add records
-	if (mode != MODE_COL) {
-		int * genotypes = (int*)malloc(bcf_hdr_nsamples(hdr)*2*sizeof(int));
-		for (int l = 0 ; l < V.size() ; l ++) {
-			bcf_clear1(rec);
-			rec->rid = bcf_hdr_name2id(hdr, V.vec_pos[l]->chr.c_str());
-			rec->pos = V.vec_pos[l]->bp - 1;
-			bcf_update_id(hdr, rec, V.vec_pos[l]->id.c_str());
-			string alleles = V.vec_pos[l]->ref + "," + V.vec_pos[l]->alt;
-			bcf_update_alleles_str(hdr, rec, alleles.c_str());
-			int count_alt = 0;
-			for (int i = 0 ; i < G.n_ind ; i++) {
-				bool a0 = G.vecG[i]->H0[l];
-				bool a1 = G.vecG[i]->H1[l];
-				count_alt += a0+a1;
-				genotypes[2*i+0] = bcf_gt_phased(a0);
-				genotypes[2*i+1] = bcf_gt_phased(a1);
-			}
-			bcf_update_info_int32(hdr, rec, "AC", &count_alt, 1);
-			float freq_alt = count_alt * 1.0 / (2 * G.n_ind);
-			bcf_update_info_float(hdr, rec, "AF", &freq_alt, 1);
-			if (V.vec_pos[l]->cm >= 0) {
-				float val = (float)V.vec_pos[l]->cm;
-				bcf_update_info_float(hdr, rec, "CM", &val, 1);
-			}
-			bcf_update_genotypes(hdr, rec, genotypes, bcf_hdr_nsamples(hdr)*2);
-			bcf_write1(fp, hdr, rec);
-			vrb.progress("  * VCF writing", (l+1)*1.0/V.size());
-		}
-		free(genotypes);
-	} else {
-		float * posteriors = (float*)malloc(bcf_hdr_nsamples(hdr)*4*sizeof(float));
-		for (int l = 0 ; l < V.size() ; l ++) {
+	//Two record blocks: workers fill the next one while the current one is written
+	if (mode != MODE_COL) block_genotypes = vector < int > (2 * BLOCK_SIZE * 2 * G.n_ind * n_draws);
+	else block_posteriors = vector < float > (2 * BLOCK_SIZE * 4 * G.n_ind);
+	block_counts = vector < int > (2 * BLOCK_SIZE);
+	block_freqs = vector < float > (2 * BLOCK_SIZE);
+
+	//Multi-threading: workers live for the whole writing
+	int n_variants = V.size();
+	if (T > 1) {
+		id_workers = vector < pthread_t > (T);
+		pthread_mutex_init(&mutex_workers, NULL);
+		pthread_cond_init(&cond_jobs, NULL);
+		pthread_cond_init(&cond_filled, NULL);
+		i_jobs = end_jobs = n_filled = 0;
+		done_jobs = false;
+		for (int t = 0 ; t < T ; t++) pthread_create( &id_workers[t] , NULL, fill_callback, static_cast<void *>(this));
+		releaseBlock(min(BLOCK_SIZE, n_variants));
+	}
+
+	//Add records, one block of variants at a time
+	for (int block_start = 0 ; block_start < n_variants ; block_start += BLOCK_SIZE) {
+		int block_end = min(block_start + BLOCK_SIZE, n_variants);
+		if (T > 1) {
+			waitBlock(block_end);
+			releaseBlock(min(block_end + BLOCK_SIZE, n_variants));
+		} else for (int l = block_start ; l < block_end ; l ++) fillRecord(l);
+		for (int l = block_start ; l < block_end ; l ++) {
+			int lrel = l % (2 * BLOCK_SIZE);
 			bcf_clear1(rec);
 			rec->rid = bcf_hdr_name2id(hdr, V.vec_pos[l]->chr.c_str());
 			rec->pos = V.vec_pos[l]->bp - 1;
 			bcf_update_id(hdr, rec, V.vec_pos[l]->id.c_str());
 			string alleles = V.vec_pos[l]->ref + "," + V.vec_pos[l]->alt;
 			bcf_update_alleles_str(hdr, rec, alleles.c_str());
-			float count_alt = 0;
-			for (int i = 0 ; i < G.n_ind ; i++) {
-				float rr = G.vecG[i]->Collapsed[4*l+0];
-				float ra = G.vecG[i]->Collapsed[4*l+1];
-				float ar = G.vecG[i]->Collapsed[4*l+2];
-				float aa = G.vecG[i]->Collapsed[4*l+3];
-				float scale = 1.0/(rr+ra+ar+aa);
-				rr *= scale;
-				ra *= scale;
-				ar *= scale;
-				aa *= scale;
-				count_alt += ra+ar+2.0*aa;
-				posteriors[4*i+0] = rr;
-				posteriors[4*i+1] = ra;
-				posteriors[4*i+2] = ar;
-				posteriors[4*i+3] = aa;
-			}
-			int count_alt_int = (int)count_alt;
-			bcf_update_info_int32(hdr, rec, "AC", &count_alt_int, 1);
-			float freq_alt = count_alt * 1.0 / (2 * G.n_ind);
-			bcf_update_info_float(hdr, rec, "AF", &freq_alt, 1);
+			bcf_update_info_int32(hdr, rec, "AC", &block_counts[lrel], 1);
+			bcf_update_info_float(hdr, rec, "AF", &block_freqs[lrel], 1);
 			if (V.vec_pos[l]->cm >= 0) {
 				float val = (float)V.vec_pos[l]->cm;
 				bcf_update_info_float(hdr, rec, "CM", &val, 1);
 			}
-			bcf_update_format_float(hdr, rec, "PO", posteriors, bcf_hdr_nsamples(hdr)*4);
+			if (mode != MODE_COL) bcf_update_genotypes(hdr, rec, &block_genotypes[lrel * 2 * G.n_ind * n_draws], bcf_hdr_nsamples(hdr)*2);
+			else bcf_update_format_float(hdr, rec, "PO", &block_posteriors[lrel * 4 * G.n_ind], bcf_hdr_nsamples(hdr)*4);
 			bcf_write1(fp, hdr, rec);
 			vrb.progress("  * VCF writing", (l+1)*1.0/V.size());
 		}
-		free(posteriors);
+	}
+	if (T > 1) {
+		pthread_mutex_lock(&mutex_workers);
+		done_jobs = true;
+		pthread_cond_broadcast(&cond_jobs);
+		pthread_mutex_unlock(&mutex_workers);
+		for (int t = 0 ; t < T ; t++) pthread_join( id_workers[t] , NULL);
+		pthread_cond_destroy(&cond_jobs);
+		pthread_cond_destroy(&cond_filled);
+		pthread_mutex_destroy(&mutex_workers);
 	}
 	bcf_destroy1(rec);
 	bcf_hdr_destroy(hdr);
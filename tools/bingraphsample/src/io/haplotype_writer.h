@@ -34,12 +34,31 @@ public:
 	genotype_set & G;
 	variant_map & V;
 
+	//RECORD BLOCKS [filled in parallel, written serially / two blocks in flight, indexed by variant modulo 2 x BLOCK_SIZE]
+	int mode, n_draws;
+	vector < int > block_genotypes;
+	vector < int > block_counts;
+	vector < float > block_posteriors;
+	vector < float > block_freqs;
+
+	//MULTI-THREADING [persistent workers synchronised once per block]
+	int i_jobs, end_jobs, n_filled;
+	bool done_jobs;
+	vector < pthread_t > id_workers;
+	pthread_mutex_t mutex_workers;
+	pthread_cond_t cond_jobs, cond_filled;
+
 	//CONSTRUCTORS/DESCTRUCTORS
 	haplotype_writer(genotype_set &, variant_map &);
 	~haplotype_writer();
 
+	//ROUTINES
+	void fillRecord(int);
+	void releaseBlock(int);
+	void waitBlock(int);
+
 	//IO
-	void writeHaplotypes(string foutput, int, int);
+	void writeHaplotypes(string foutput, int, int, int, int n_draws = 1);
 };
 
 #endif
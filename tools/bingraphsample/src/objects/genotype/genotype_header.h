@@ -23,6 +23,7 @@
 #define _GENOTYPE_H
 
 #include <utils/otools.h>
+#include <utils/buffer_view.h>
 
 #define HAP_NUMBER	8
 
@@ -36,6 +37,9 @@
 #define HAP_GET(hap, idx)	(((hap)>>(idx))&1U)
 #define HAP_SET(hap, idx)	((hap)|=(1U<<(idx)))
 
+//Macro for reading packed transition masks (LSB first, as serialized in BIN files)
+#define MASK_GET(mask, idx)	(((mask)[(idx)>>3]>>((idx)&7))&1U)
+
 //Macros for packing/unpacking variants
 #define VAR_GET_HOM(e,v)	((((v)>>((e)<<2))&3)==0)
 #define VAR_GET_MIS(e,v)	((((v)>>((e)<<2))&3)==1)
@@ -53,6 +57,9 @@
 #define VAR_SET_HAP1(e,v)	((v)|=(8<<((e)<<2)))
 #define VAR_CLR_HAP1(e,v)	((e)?((v)&=127):((v)&=247))
 
+//Quantized phase probabilities [as written by shapeit4 --bingraph-bits], normalised by the number of storage events
+#define PROB_QUANT_LOGMIN	13.815510557964274	//-log(1e-6)
+
 class genotype {
 public:
 	// INTERNAL DATA
@@ -67,31 +74,37 @@ public:
 	unsigned int n_storage_events;			// Number of storage having been done
 	unsigned char curr_dipcodes [64];		// List of diplotypes in a given segment (buffer style variable)
 
-	// VARIANT / HAPLOTYPE / DIPLOTYPE DATA
-	vector < unsigned char > Variants;		// 0.5 byte per variant
-	vector < unsigned char > Ambiguous;		// 1 byte per ambiguous variant
-	vector < unsigned long > Diplotypes;	// 8 bytes per segment
-	vector < unsigned short > Lengths;		// 2 bytes per segment
+	// VARIANT / HAPLOTYPE / DIPLOTYPE DATA (owned or viewed in place in a mapped BIN file)
+	buffer_view < unsigned char > Variants;		// 0.5 byte per variant
+	buffer_view < unsigned char > Ambiguous;	// 1 byte per ambiguous variant
+	buffer_view < unsigned long > Diplotypes;	// 8 bytes per segment
+	buffer_view < unsigned short > Lengths;		// 2 bytes per segment
 	vector < bool > H0;
 	vector < bool > H1;
 	vector < unsigned short > Collapsed;
 
 	//PHASE PROBS
-	vector < bool > ProbMask;
-	vector < float > ProbStored;
-	vector < float > ProbMissing;
+	buffer_view < unsigned char > ProbMask;	// 1 bit per transition
+	buffer_view < float > ProbStored;
+	buffer_view < float > ProbMissing;
+
+	//ALIAS TABLES [forward: one per transition row, same layout as transitions / backward: one per transition column, then one over the last block]
+	vector < float > AliasProb;
+	vector < unsigned short > AliasIdx;
 
 	//METHODS
 	genotype(unsigned int);
 	~genotype();
 	void free();
 	void makeBest(vector < unsigned char > &);
-	void makeSample(vector < unsigned char > &);
-	void sample();
-	void sampleForward(vector < float > &);
-	void sampleBackward(vector < float > &);
+	void makeSample(vector < unsigned char > &, counter_rng &, unsigned int draw = 0);
+	void sample(counter_rng &);
+	void sampleForward(vector < float > &, counter_rng &);
+	void sampleBackward(vector < float > &, counter_rng &);
+	void buildAlias(vector < float > &, unsigned int, unsigned int, unsigned int, unsigned int);
+	void draws(unsigned int, counter_rng &);
 	void solve();
-	void init();
+	void init(unsigned int n_draws = 1);
 	void storeCollapse();
 
 
@@ -99,6 +112,7 @@ public:
 	unsigned int countDiplotypes(unsigned long);
 	void makeDiplotypes(unsigned long);
 	unsigned int countTransitions();
+	unsigned int sampleAlias(unsigned int, unsigned int, counter_rng &);
 };
 
 inline
@@ -124,4 +138,20 @@ unsigned int genotype::countTransitions() {
 	return c;
 }
 
+inline
+unsigned int genotype::sampleAlias(unsigned int start, unsigned int n, counter_rng & R) {
+	unsigned int k = R.getInt(n);
+	return (R.getDouble() < AliasProb[start + k])?k:AliasIdx[start + k];
+}
+
+inline
+float dequantizeTransition(unsigned int q, unsigned int n_events, unsigned int qmax) {
+	return std::max(n_events, 1U) * exp(-(q * PROB_QUANT_LOGMIN / qmax));
+}
+
+inline
+float dequantizeMissing(unsigned int q, unsigned int n_events, unsigned int qmax) {
+	return q * std::max(n_events, 1U) * 1.0 / qmax;
+}
+
 #endif
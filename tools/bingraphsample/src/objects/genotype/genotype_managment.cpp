@@ -39,34 +39,41 @@ genotype::~genotype() {
 void genotype::free() {
 	std::fill(curr_dipcodes, curr_dipcodes + 64, 0);
 	name = "";
-	vector < unsigned char > ().swap(Variants);
-	vector < unsigned char > ().swap(Ambiguous);
-	vector < unsigned long > ().swap(Diplotypes);
-	vector < unsigned short > ().swap(Lengths);
+	Variants.clear();
+	Ambiguous.clear();
+	Diplotypes.clear();
+	Lengths.clear();
+	ProbMask.clear();
+	ProbStored.clear();
+	ProbMissing.clear();
 }
 
-void genotype::init() {
-	H0 = vector < bool > (n_variants, false);
-	H1 = vector < bool > (n_variants, false);
-	for (unsigned int v = 0 ; v < n_variants ; v ++) {
-		H0[v] = VAR_GET_HAP0(MOD2(v), Variants[DIV2(v)]);
-		H1[v] = VAR_GET_HAP1(MOD2(v), Variants[DIV2(v)]);
+void genotype::init(unsigned int n_draws) {
+	H0 = vector < bool > (n_draws * n_variants, false);
+	H1 = vector < bool > (n_draws * n_variants, false);
+	for (unsigned int d = 0, vd = 0 ; d < n_draws ; d ++) {
+		for (unsigned int v = 0 ; v < n_variants ; v ++, vd ++) {
+			H0[vd] = VAR_GET_HAP0(MOD2(v), Variants[DIV2(v)]);
+			H1[vd] = VAR_GET_HAP1(MOD2(v), Variants[DIV2(v)]);
+		}
 	}
 }
 
-void genotype::makeSample(vector < unsigned char > & DipSampled) {
+void genotype::makeSample(vector < unsigned char > & DipSampled, counter_rng & R, unsigned int draw) {
+	vector < bool >::iterator D0 = H0.begin() + draw * n_variants;
+	vector < bool >::iterator D1 = H1.begin() + draw * n_variants;
 	for (unsigned int s = 0, vabs = 0, a = 0, m = 0 ; s < n_segments ; s ++) {
 		unsigned char hap0 = DIP_HAP0(DipSampled[s]);
 		unsigned char hap1 = DIP_HAP1(DipSampled[s]);
 		for (unsigned int vrel = 0 ; vrel < Lengths[s] ; vrel++, vabs++) {
 			if (VAR_GET_MIS(MOD2(vabs), Variants[DIV2(vabs)])) {
-				H0[vabs] = ((rng.getDouble()*n_storage_events)<=ProbMissing[m*HAP_NUMBER+hap0]);
-				H1[vabs] = ((rng.getDouble()*n_storage_events)<=ProbMissing[m*HAP_NUMBER+hap1]);
+				D0[vabs] = ((R.getDouble()*n_storage_events)<=ProbMissing[m*HAP_NUMBER+hap0]);
+				D1[vabs] = ((R.getDouble()*n_storage_events)<=ProbMissing[m*HAP_NUMBER+hap1]);
 				m++;
 			}
 			if (VAR_GET_AMB(MOD2(vabs), Variants[DIV2(vabs)])) {
-				H0[vabs] = HAP_GET(Ambiguous[a], hap0);
-				H1[vabs] = HAP_GET(Ambiguous[a], hap1);
+				D0[vabs] = HAP_GET(Ambiguous[a], hap0);
+				D1[vabs] = HAP_GET(Ambiguous[a], hap1);
 				a++;
 			}
 		}
@@ -21,18 +21,18 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include <objects/genotype/genotype_header.h>
 
-void genotype::sample() {
+void genotype::sample(counter_rng & R) {
 	//Unfold trans porbs
 	vector < float > unfolded_probs = vector < float > (n_transitions, 0.0f);
 	for (unsigned int t  = 0, t2 = 0 ; t < n_transitions ; t++) {
-		if (ProbMask[t]) unfolded_probs[t] =  ProbStored[t2++];
+		if (MASK_GET(ProbMask, t)) unfolded_probs[t] =  ProbStored[t2++];
 		else unfolded_probs[t] =  5e-7;
 	}
-	if (rng.getDouble() < 0.5) sampleForward(unfolded_probs);
-	else sampleBackward(unfolded_probs);
+	if (R.getDouble() < 0.5) sampleForward(unfolded_probs, R);
+	else sampleBackward(unfolded_probs, R);
 }
 
-void genotype::sampleForward(vector < float > & CurrentTransProbabilities) {
+void genotype::sampleForward(vector < float > & CurrentTransProbabilities, counter_rng & R) {
 	float sumProbs = 0.0;
 	unsigned int prev_sampled = 0;
 	unsigned int curr_dipcount = 0, prev_dipcount = 1;
@@ -43,16 +43,16 @@ void genotype::sampleForward(vector < float > & CurrentTransProbabilities) {
 		curr_dipcount = countDiplotypes(Diplotypes[s]);
 		for (unsigned int tabs = toffset + prev_sampled*curr_dipcount, trel = 0 ; trel < curr_dipcount ; ++trel, ++tabs)
 			sumProbs += (currProbs[trel] = CurrentTransProbabilities[tabs]);
-		prev_sampled = rng.sample(currProbs, sumProbs);
+		prev_sampled = R.sample(currProbs, sumProbs);
 		makeDiplotypes(Diplotypes[s]);
 		DipSampled[s] = curr_dipcodes[prev_sampled];
 		toffset += prev_dipcount * curr_dipcount;
 		prev_dipcount = curr_dipcount;
 	}
-	makeSample(DipSampled);
+	makeSample(DipSampled, R);
 }
 
-void genotype::sampleBackward(vector < float > & CurrentTransProbabilities) {
+void genotype::sampleBackward(vector < float > & CurrentTransProbabilities, counter_rng & R) {
 	float sumProbs = 0.0;
 	int next_sampled = -1;
 	unsigned int curr_dipcount = 0, next_dipcount = countDiplotypes(Diplotypes[n_segments - 1]);
@@ -68,13 +68,13 @@ void genotype::sampleBackward(vector < float > & CurrentTransProbabilities) {
 			currProbs.resize(64);
 			for (unsigned int tabs = toffset+next_sampled, trel = 0 ; trel < curr_dipcount ; ++trel, tabs += next_dipcount)
 				sumProbs += (currProbs[trel] = CurrentTransProbabilities[tabs]);
-			next_sampled = rng.sample(currProbs, sumProbs);
+			next_sampled = R.sample(currProbs, sumProbs);
 			makeDiplotypes(Diplotypes[s]);
 			DipSampled[s] = curr_dipcodes[next_sampled];
 		} else {
 			for (unsigned int tabs = toffset, trel = 0 ; tabs < n_transitions ; ++trel, ++tabs)
 				sumProbs += (currProbs[trel] = CurrentTransProbabilities[tabs]);
-			next_sampled = rng.sample(currProbs, sumProbs);
+			next_sampled = R.sample(currProbs, sumProbs);
 			makeDiplotypes(Diplotypes[s+1]);
 			DipSampled[s+1] = curr_dipcodes[next_sampled % next_dipcount];
 			makeDiplotypes(Diplotypes[s]);
@@ -83,7 +83,88 @@ void genotype::sampleBackward(vector < float > & CurrentTransProbabilities) {
 		}
 		next_dipcount = curr_dipcount;
 	}
-	makeSample(DipSampled);
+	makeSample(DipSampled, R);
+}
+
+void genotype::buildAlias(vector < float > & CurrentTransProbabilities, unsigned int start, unsigned int stride, unsigned int n, unsigned int out) {
+	//Vose's alias method over n transition probabilities spaced by stride [n <= 64 x 64], table written at out
+	float sumProbs = 0.0f, scaled [4096];
+	unsigned short small [4096], large [4096];
+	unsigned int n_small = 0, n_large = 0;
+	for (unsigned int k = 0 ; k < n ; k ++) sumProbs += CurrentTransProbabilities[start + k * stride];
+	for (unsigned int k = 0 ; k < n ; k ++) {
+		scaled[k] = CurrentTransProbabilities[start + k * stride] * n / sumProbs;
+		if (scaled[k] < 1.0f) small[n_small++] = k;
+		else large[n_large++] = k;
+	}
+	while (n_small && n_large) {
+		unsigned short ks = small[--n_small], kl = large[--n_large];
+		AliasProb[out + ks] = scaled[ks];
+		AliasIdx[out + ks] = kl;
+		scaled[kl] = (scaled[kl] + scaled[ks]) - 1.0f;
+		if (scaled[kl] < 1.0f) small[n_small++] = kl;
+		else large[n_large++] = kl;
+	}
+	while (n_large) { AliasProb[out + large[--n_large]] = 1.0f; }
+	while (n_small) { AliasProb[out + small[--n_small]] = 1.0f; }
+}
+
+void genotype::draws(unsigned int n_draws, counter_rng & R) {
+	//Unfold trans probs
+	vector < float > unfolded_probs = vector < float > (n_transitions, 0.0f);
+	for (unsigned int t  = 0, t2 = 0 ; t < n_transitions ; t++) {
+		if (MASK_GET(ProbMask, t)) unfolded_probs[t] =  ProbStored[t2++];
+		else unfolded_probs[t] =  5e-7;
+	}
+
+	//Diplotype counts, codes and transition block offsets of each segment
+	vector < unsigned int > dipcounts = vector < unsigned int > (n_segments, 0);
+	vector < unsigned int > dipstarts = vector < unsigned int > (n_segments, 0);
+	vector < unsigned int > toffsets = vector < unsigned int > (n_segments, 0);
+	vector < unsigned char > dipcodes;
+	for (unsigned int s = 0, toffset = 0, prev_dipcount = 1 ; s < n_segments ; s ++) {
+		dipcounts[s] = countDiplotypes(Diplotypes[s]);
+		dipstarts[s] = dipcodes.size();
+		makeDiplotypes(Diplotypes[s]);
+		dipcodes.insert(dipcodes.end(), curr_dipcodes, curr_dipcodes + dipcounts[s]);
+		toffsets[s] = toffset;
+		toffset += prev_dipcount * dipcounts[s];
+		prev_dipcount = dipcounts[s];
+	}
+
+	//Build all alias tables once, for both sampling directions [see sampleForward and sampleBackward]
+	unsigned int n_last = (n_segments > 1)?(dipcounts[n_segments - 2] * dipcounts[n_segments - 1]):0;
+	AliasProb = vector < float > (2 * n_transitions + n_last, 1.0f);
+	AliasIdx = vector < unsigned short > (2 * n_transitions + n_last, 0);
+	for (unsigned int s = 0, prev_dipcount = 1 ; s < n_segments ; s ++) {
+		for (unsigned int p = 0 ; p < prev_dipcount ; p ++) buildAlias(unfolded_probs, toffsets[s] + p * dipcounts[s], 1, dipcounts[s], toffsets[s] + p * dipcounts[s]);
+		if (s) for (unsigned int n = 0 ; n < dipcounts[s] ; n ++) buildAlias(unfolded_probs, toffsets[s] + n, dipcounts[s], prev_dipcount, n_transitions + toffsets[s] + n * prev_dipcount);
+		prev_dipcount = dipcounts[s];
+	}
+	if (n_last) buildAlias(unfolded_probs, toffsets[n_segments - 1], 1, n_last, 2 * n_transitions);
+
+	//Each draw then picks a direction at random as sample() does and is O(1) per segment
+	vector < unsigned char > DipSampled = vector < unsigned char >(n_segments, 0);
+	for (unsigned int d = 0 ; d < n_draws ; d ++) {
+		if (R.getDouble() < 0.5 || n_segments < 2) {
+			for (unsigned int s = 0, prev_sampled = 0 ; s < n_segments ; s ++) {
+				prev_sampled = sampleAlias(toffsets[s] + prev_sampled * dipcounts[s], dipcounts[s], R);
+				DipSampled[s] = dipcodes[dipstarts[s] + prev_sampled];
+			}
+		} else {
+			unsigned int s = n_segments - 1, next_sampled = sampleAlias(2 * n_transitions, n_last, R);
+			DipSampled[s] = dipcodes[dipstarts[s] + next_sampled % dipcounts[s]];
+			next_sampled /= dipcounts[s];
+			DipSampled[s - 1] = dipcodes[dipstarts[s - 1] + next_sampled];
+			for (s = n_segments - 2 ; s > 0 ; s --) {
+				next_sampled = sampleAlias(n_transitions + toffsets[s] + next_sampled * dipcounts[s - 1], dipcounts[s - 1], R);
+				DipSampled[s - 1] = dipcodes[dipstarts[s - 1] + next_sampled];
+			}
+		}
+		makeSample(DipSampled, R, d);
+	}
+	vector < float > ().swap(AliasProb);
+	vector < unsigned short > ().swap(AliasIdx);
 }
 
 void genotype::solve() {
@@ -98,7 +179,7 @@ void genotype::solve() {
 		for (int t = 0 ; t < prev_dipcount * curr_dipcount ; t++) {
 			int prev_dip = t/curr_dipcount;
 			int next_dip = t%curr_dipcount;
-			double currProb = (s?maxProbs[s-1][prev_dip]:1.0) * (ProbMask[t+toffset]?ProbStored[trel++]:5e-7);
+			double currProb = (s?maxProbs[s-1][prev_dip]:1.0) * (MASK_GET(ProbMask, t+toffset)?ProbStored[trel++]:5e-7);
 			if (currProb > maxProbs[s][next_dip]) {
 				maxProbs[s][next_dip] = currProb;
 				maxIndexes[s][next_dip] = prev_dip;
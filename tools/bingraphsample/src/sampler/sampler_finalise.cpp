@@ -26,30 +26,35 @@
 #define MODE_SPL	0
 #define MODE_SOL	1
 #define MODE_COL	2
+#define MODE_DRW	3
 
 void sampler::write_files_and_finalise() {
 	vrb.title("Finalization:");
 
 	//
 	int mode;
-	G.init();
+	G.init(options.count("draws")?options["draws"].as < int > ():1);
 	if (options.count("sample")) {
-		G.sample();
+		G.sample(options["thread"].as < int > ());
 		mode = MODE_SPL;
 	}
 	if (options.count("solve")) {
-		G.solve();
+		G.solve(options["thread"].as < int > ());
 		mode = MODE_SOL;
 	}
 	if (options.count("collapse")) {
 		G.collapse(options["collapse"].as < int > (), options["thread"].as < int > ());
 		mode = MODE_COL;
 	}
+	if (options.count("draws")) {
+		G.draws(options["draws"].as < int > (), options["thread"].as < int > ());
+		mode = MODE_DRW;
+	}
 
 
 
 	//step1: writing best guess haplotypes in VCF/BCF file
-	haplotype_writer(G, V).writeHaplotypes(options["output"].as < string > (), mode, options["seed"].as < int > ());
+	haplotype_writer(G, V).writeHaplotypes(options["output"].as < string > (), mode, options["seed"].as < int > (), options["thread"].as < int > (), options.count("draws")?options["draws"].as < int > ():1);
 
 	if (options["thread"].as < int > () > 1) pthread_mutex_destroy(&G.mutex_workers);
 
@@ -28,6 +28,7 @@ void sampler::read_files_and_initialise() {
 
 	//step0: Initialize seed and multi-threading
 	rng.setSeed(options["seed"].as < int > ());
+	G.seed = options["seed"].as < int > ();
 
 	if (options["thread"].as < int > () > 1) {
 		G.i_workers = 0;
@@ -37,7 +38,17 @@ void sampler::read_files_and_initialise() {
 	}
 
 
+	//step1: Read list of samples to be loaded
+	set < string > subset;
+	if (options.count("include")) {
+		string buffer;
+		input_file fd (options["include"].as < string > ());
+		if (fd.fail()) vrb.error("Impossible to open [" + options["include"].as < string > () + "]");
+		while (getline(fd, buffer)) if (buffer.size()) subset.insert(buffer);
+		vrb.bullet("Sample list [n=" + stb.str(subset.size()) + "]");
+	}
+
 	//step2: Read input files
 	graph_reader readerG(G, V);
-	readerG.readGraphs(options["input"].as < string > ());
+	readerG.readGraphs(options["input"].as < string > (), subset);
 }
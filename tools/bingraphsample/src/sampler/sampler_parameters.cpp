@@ -31,13 +31,15 @@ void sampler::declare_options() {
 
 	bpo::options_description opt_input ("Input files");
 	opt_input.add_options()
-			("input,I", bpo::value< string >(), "Genotypes to be phased in VCF/BCF format");
+			("input,I", bpo::value< string >(), "Genotypes to be phased in VCF/BCF format")
+			("include", bpo::value< string >(), "List of samples to load from an indexed BIN file [one sample ID per line]");
 
 	bpo::options_description opt_sample ("SAMPLING parameters");
 	opt_sample.add_options()
 			("sample", "Sample a pair of haplotypes per individual, use in combination of --seed")
 			("solve", "Output the most likely pair of haplotypes per individual")
-			("collapse", bpo::value<int>(), "Collapse X sampling (use it for scaffolded samples only; X < 65,000)");
+			("collapse", bpo::value<int>(), "Collapse X sampling (use it for scaffolded samples only; X < 65,000)")
+			("draws", bpo::value<int>(), "Sample X pairs of haplotypes per individual in a single pass, use in combination of --seed [one output column per draw]");
 
 	bpo::options_description opt_output ("Output files");
 	opt_output.add_options()
@@ -69,8 +71,11 @@ void sampler::check_options() {
 	if (!options.count("input"))
 		vrb.error("You must specify one input file using --input");
 
-	if ((options.count("sample")+options.count("solve")+options.count("collapse"))!=1)
-		vrb.error("You must specify either --sample or --solve or --collapse");
+	if ((options.count("sample")+options.count("solve")+options.count("collapse")+options.count("draws"))!=1)
+		vrb.error("You must specify either --sample or --solve or --collapse or --draws");
+
+	if (options.count("draws") && options["draws"].as < int > () < 1)
+		vrb.error("You must specify a positive number of draws using --draws");
 
 	if (options.count("seed") && options["seed"].as < int > () < 0)
 		vrb.error("Random number generator needs a positive seed value");
@@ -83,6 +88,7 @@ void sampler::check_options() {
 void sampler::verbose_files() {
 	vrb.title("Files:");
 	vrb.bullet("Input BIN     : [" + options["input"].as < string > () + "]");
+	if (options.count("include")) vrb.bullet("Input LIST    : [" + options["include"].as < string > () + "]");
 	vrb.bullet("Output VCF    : [" + options["output"].as < string > () + "]");
 	if (options.count("log")) vrb.bullet("Output LOG    : [" + options["log"].as < string > () + "]");
 }
@@ -94,4 +100,5 @@ void sampler::verbose_options() {
 	if (options.count("sample")) vrb.bullet("MODE    : Sampling using seed [" + stb.str(options["seed"].as < int > ()) + "]");
 	if (options.count("solve")) vrb.bullet("MODE    : Solving");
 	if (options.count("collapse")) vrb.bullet("MODE    : Collpase haplotypes from [" + stb.str(options["collapse"].as < int > ()) + "] samplings");
+	if (options.count("draws")) vrb.bullet("MODE    : Drawing [" + stb.str(options["draws"].as < int > ()) + "] haplotype pairs per sample using seed [" + stb.str(options["seed"].as < int > ()) + "]");
 }
@@ -0,0 +1,84 @@
+/*******************************************************************************
+ * Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+#ifndef _BUFFER_VIEW_H
+#define _BUFFER_VIEW_H
+
+#include <vector>
+#include <cstddef>
+
+//Array that either owns its storage or views memory owned elsewhere (e.g. a memory mapped file)
+template < class T >
+class buffer_view {
+protected:
+	std::vector < T > owned;
+	T * ptr;
+	size_t n;
+
+public:
+	buffer_view() {
+		ptr = NULL;
+		n = 0;
+	}
+
+	buffer_view(const buffer_view < T > & b) : owned(b.owned) {
+		ptr = owned.empty()?b.ptr:owned.data();
+		n = b.n;
+	}
+
+	buffer_view < T > & operator = (const buffer_view < T > & b) {
+		owned = b.owned;
+		ptr = owned.empty()?b.ptr:owned.data();
+		n = b.n;
+		return *this;
+	}
+
+	~buffer_view() {
+		clear();
+	}
+
+	void allocate(size_t _n) {
+		owned = std::vector < T > (_n);
+		ptr = owned.data();
+		n = _n;
+	}
+
+	void view(T * _ptr, size_t _n) {
+		std::vector < T > ().swap(owned);
+		ptr = _ptr;
+		n = _n;
+	}
+
+	void clear() {
+		std::vector < T > ().swap(owned);
+		ptr = NULL;
+		n = 0;
+	}
+
+	bool owning() const { return !owned.empty(); }
+	size_t size() const { return n; }
+	T * data() { return ptr; }
+	T & operator [] (size_t i) { return ptr[i]; }
+	const T & operator [] (size_t i) const { return ptr[i]; }
+	T & back() { return ptr[n-1]; }
+};
+
+#endif
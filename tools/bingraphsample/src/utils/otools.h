@@ -58,6 +58,7 @@ extern "C" {
 //INCLUDES BASE STUFFS
 #include <utils/compressed_io.h>
 #include <utils/random_number.h>
+#include <utils/counter_rng.h>
 #include <utils/basic_stats.h>
 #include <utils/basic_algos.h>
 #include <utils/string_utils.h>
@@ -0,0 +1,80 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+#include <driver/driver_header.h>
+
+#include <evaluation/switch_error.h>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+void driver::benchmark() {
+	int nthreads = options["thread"].as < int > ();
+	for (int r = 0 ; r < Configs.size() ; r ++) {
+		vrb.title("Configuration [" + Configs[r].name + "]");
+		string data = work + "/" + Configs[r].dataset;
+		string phased = work + "/" + Configs[r].name + ".phased.bcf";
+		vector < string > cmd = { options["shapeit"].as < string > (), "--input", data + ".bcf", "--map", data + ".gmap.gz", "--region", Configs[r].region, "--output", phased, "--seed", stb.str(options["seed"].as < int > ()), "--thread", stb.str(nthreads) };
+		cmd.insert(cmd.end(), Configs[r].args.begin(), Configs[r].args.end());
+
+		run_record rec;
+		rec.config = Configs[r].name;
+		execute(cmd, work + "/" + Configs[r].name + ".log", rec.wall, rec.max_rss);
+		vrb.bullet("Phasing [wall=" + stb.str(rec.wall, 2) + "s / peak memory=" + stb.str(rec.max_rss, 1) + "Mb]");
+
+		if (bcf_index_build3(phased.c_str(), NULL, 14, nthreads) < 0) vrb.error("Failing to index phased haplotypes [" + phased + "]");
+		switch_error S;
+		S.compute(data + ".truth.bcf", phased, Configs[r].region, nthreads, Configs[r].excluded);
+		rec.ser = S.rate();
+		rec.n_pairs = S.n_pairs;
+		Report.Records.push_back(rec);
+	}
+}
+
+//Runs a command with stdout/stderr redirected to a log file, and measures its wall clock time and peak memory
+void driver::execute(vector < string > & cmd, string flog, double & wall, double & max_rss) {
+	vector < char * > argv;
+	for (int a = 0 ; a < cmd.size() ; a ++) argv.push_back(const_cast < char * > (cmd[a].c_str()));
+	argv.push_back(NULL);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	pid_t pid = fork();
+	if (pid < 0) vrb.error("Impossible to start [" + cmd[0] + "]");
+	if (pid == 0) {
+		int fd = open(flog.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (fd >= 0) {
+			dup2(fd, STDOUT_FILENO);
+			dup2(fd, STDERR_FILENO);
+			::close(fd);
+		}
+		execvp(argv[0], argv.data());
+		_exit(127);
+	}
+	int status = 0;
+	struct rusage usage;
+	if (wait4(pid, &status, 0, &usage) < 0) vrb.error("Impossible to wait for [" + cmd[0] + "]");
+	wall = std::chrono::duration < double > (std::chrono::steady_clock::now() - start).count();
+	max_rss = usage.ru_maxrss / 1024.0;
+	if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) vrb.error("Command [" + cmd[0] + "] failed, see [" + flog + "]");
+}
@@ -0,0 +1,57 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+#include <driver/driver_header.h>
+
+void driver::write_files_and_finalise() {
+	vrb.title("Finalization:");
+	if (options.count("output")) {
+		Report.write(options["output"].as < string > ());
+		vrb.bullet("Report writing [" + options["output"].as < string > () + "]");
+	}
+
+	//Regression gate: every configuration is compared against its baseline
+	unsigned int n_failed = 0;
+	if (options.count("baseline")) {
+		Baseline.read(options["baseline"].as < string > ());
+		double tol_time = options["tolerance-time"].as < double > ();
+		double tol_memory = options["tolerance-memory"].as < double > ();
+		double tol_ser = options["tolerance-ser"].as < double > ();
+		for (int r = 0 ; r < Report.Records.size() ; r ++) {
+			run_record & curr = Report.Records[r];
+			int b = Baseline.find(curr.config);
+			if (b < 0) {
+				vrb.warning("No baseline for configuration [" + curr.config + "]");
+				continue;
+			}
+			run_record & base = Baseline.Records[b];
+			bool fail_time = (curr.wall > base.wall * (1.0 + tol_time));
+			bool fail_memory = (curr.max_rss > base.max_rss * (1.0 + tol_memory));
+			bool fail_ser = (curr.ser > base.ser + tol_ser);
+			vrb.bullet(curr.config + " [time=" + stb.str(curr.wall, 2) + "s vs " + stb.str(base.wall, 2) + "s" + (fail_time?" FAIL":"") + " / memory=" + stb.str(curr.max_rss, 1) + "Mb vs " + stb.str(base.max_rss, 1) + "Mb" + (fail_memory?" FAIL":"") + " / SER=" + stb.str(curr.ser, 3) + "% vs " + stb.str(base.ser, 3) + "%" + (fail_ser?" FAIL":"") + "]");
+			n_failed += fail_time + fail_memory + fail_ser;
+		}
+	}
+
+	vrb.bullet("Total running time = " + stb.str(tac.abs_time()) + " seconds");
+	if (n_failed) vrb.error("Regression gate failed for " + stb.str(n_failed) + " measure(s)");
+	if (options.count("baseline")) vrb.bullet("Regression gate passed");
+}
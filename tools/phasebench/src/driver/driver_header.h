@@ -0,0 +1,70 @@
+/*******************************************************************************
+ * Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+#ifndef _DRIVER_H
+#define _DRIVER_H
+
+#include <utils/otools.h>
+
+#include <io/baseline_file.h>
+
+//One run of the phasing software, on one of the simulated datasets
+struct run_config {
+	string name;
+	string dataset;
+	vector < string > args;		// Options added to the input/map/region/output ones
+	string region;				// Chromosome of the dataset [read from its truth]
+	string excluded;			// Haplotypes given as input, whose samples are left out of the SER [empty for none]
+};
+
+class driver {
+public:
+	//COMMAND LINE OPTIONS
+	bpo::options_description descriptions;
+	bpo::variables_map options;
+
+	//INTERNAL DATA
+	string work;						// Directory of the datasets, phased outputs and logs
+	vector < run_config > Configs;
+	baseline_file Report, Baseline;
+
+	//CONSTRUCTOR
+	driver();
+	~driver();
+
+	//PARAMETERS
+	void declare_options();
+	void parse_command_line(vector < string > &);
+	void check_options();
+	void verbose_options();
+	void verbose_files();
+
+	//
+	void run(vector < string > &);
+	void read_files_and_initialise();
+	void generate(string, vector < string >);
+	string contig(string);
+	void benchmark();
+	void execute(vector < string > &, string, double &, double &);
+	void write_files_and_finalise();
+};
+
+#endif
@@ -0,0 +1,102 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+#include <driver/driver_header.h>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <cerrno>
+
+void driver::read_files_and_initialise() {
+	vrb.title("Initialization:");
+	work = options["work"].as < string > ();
+	if (mkdir(work.c_str(), 0755) && errno != EEXIST) vrb.error("Impossible to create work directory [" + work + "]");
+
+	//Fixed set of configurations [the datasets they share are simulated once]
+	run_config c;
+	c.name = "array"; c.dataset = "array"; c.args = vector < string > ();
+	Configs.push_back(c);
+	c.name = "sequencing"; c.dataset = "sequencing"; c.args = vector < string > { "--sequencing" };
+	Configs.push_back(c);
+	c.name = "reference"; c.dataset = "array"; c.args = vector < string > { "--reference", work + "/array.reference.bcf" };
+	Configs.push_back(c);
+	c.name = "scaffold"; c.dataset = "array"; c.args = vector < string > { "--scaffold", work + "/array.scaffold.bcf" }; c.excluded = work + "/array.scaffold.bcf";
+	Configs.push_back(c);
+	c.excluded = "";
+	c.name = "use-PS"; c.dataset = "array"; c.args = vector < string > { "--use-PS", "0.0001" };
+	Configs.push_back(c);
+
+	if (options.count("configs")) {
+		vector < string > selected;
+		vector < run_config > kept;
+		stb.split(options["configs"].as < string > (), selected, ",");
+		for (int s = 0 ; s < selected.size() ; s ++) {
+			int idx = -1;
+			for (int r = 0 ; r < Configs.size() ; r ++) if (Configs[r].name == selected[s]) idx = r;
+			if (idx < 0) vrb.error("Unknown configuration [" + selected[s] + "]");
+			kept.push_back(Configs[idx]);
+		}
+		Configs = kept;
+	}
+
+	//Datasets: array-like [common variants, PS, scaffold and reference panel] and sequencing-like [dense, mostly rare variants]
+	string n_samples = stb.str(options["n-samples"].as < int > ());
+	string n_reference = stb.str(options["n-samples"].as < int > () / 2);
+	bool use_array = false, use_sequencing = false;
+	for (int r = 0 ; r < Configs.size() ; r ++) {
+		use_array |= (Configs[r].dataset == "array");
+		use_sequencing |= (Configs[r].dataset == "sequencing");
+	}
+	if (use_array) generate("array", vector < string > { "--n-samples", n_samples, "--n-reference", n_reference, "--scaffold", "0.1", "--n-sites", "20000", "--length", "40", "--het", "0.25", "--rare", "0.05", "--missing", "0.005", "--ps-rate", "0.2", "--ps-length", "4" });
+	if (use_sequencing) generate("sequencing", vector < string > { "--n-samples", n_samples, "--n-sites", "40000", "--length", "4", "--het", "0.15", "--rare", "0.6" });
+	for (int r = 0 ; r < Configs.size() ; r ++) Configs[r].region = contig(work + "/" + Configs[r].dataset + ".truth.bcf");
+}
+
+//Chromosome a simulated dataset lies on [first contig of its header]
+string driver::contig(string ftruth) {
+	htsFile * fp = hts_open(ftruth.c_str(), "r");
+	if (!fp) vrb.error("Impossible to open truth haplotypes [" + ftruth + "]");
+	bcf_hdr_t * hdr = bcf_hdr_read(fp);
+	if (!hdr) vrb.error("Impossible to read the header of [" + ftruth + "]");
+	int n_contigs = 0;
+	const char ** names = bcf_hdr_seqnames(hdr, &n_contigs);
+	if (!n_contigs) vrb.error("No contig declared in [" + ftruth + "]");
+	string chr = string(names[0]);
+	free(names);
+	bcf_hdr_destroy(hdr);
+	hts_close(fp);
+	return chr;
+}
+
+void driver::generate(string dataset, vector < string > args) {
+	string prefix = work + "/" + dataset;
+	struct stat st;
+	if (stat((prefix + ".truth.bcf.csi").c_str(), &st) == 0) {
+		vrb.bullet("Dataset [" + dataset + "] reused from [" + prefix + "]");
+		return;
+	}
+	tac.clock();
+	vector < string > cmd = { options["simcohort"].as < string > (), "--seed", stb.str(options["seed"].as < int > ()), "--thread", stb.str(options["thread"].as < int > ()), "--output", prefix };
+	cmd.insert(cmd.end(), args.begin(), args.end());
+	double wall, max_rss;
+	execute(cmd, prefix + ".simulation.log", wall, max_rss);
+	vrb.bullet("Dataset [" + dataset + "] simulated in [" + prefix + "] (" + stb.str(tac.rel_time()*1.0/1000, 2) + "s)");
+}
@@ -0,0 +1,108 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+#include <driver/driver_header.h>
+
+void driver::declare_options() {
+	bpo::options_description opt_base ("Basic options");
+	opt_base.add_options()
+			("help", "Produce help message")
+			("seed", bpo::value<int>()->default_value(15052011), "Seed used to simulate the datasets and to phase them")
+			("thread,T", bpo::value<int>()->default_value(1), "Number of thread used by the phasing runs");
+
+	bpo::options_description opt_binary ("Binaries");
+	opt_binary.add_options()
+			("shapeit", bpo::value< string >()->default_value("bin/shapeit4.2"), "Phasing binary to benchmark")
+			("simcohort", bpo::value< string >()->default_value("tools/simcohort/bin/simcohort"), "Simulator used to generate the datasets");
+
+	bpo::options_description opt_runs ("Runs");
+	opt_runs.add_options()
+			("work,W", bpo::value< string >()->default_value("phasebench"), "Directory for datasets, phased haplotypes and logs [datasets already there are reused]")
+			("configs", bpo::value< string >(), "Comma separated list of configurations to run [array,sequencing,reference,scaffold,use-PS; all by default]")
+			("n-samples,N", bpo::value< int >()->default_value(1000), "Number of individuals per simulated dataset");
+
+	bpo::options_description opt_gate ("Baseline and tolerances");
+	opt_gate.add_options()
+			("baseline,B", bpo::value< string >(), "Baseline file to compare against")
+			("tolerance-time", bpo::value< double >()->default_value(0.20), "Maximal relative increase of the wall clock time")
+			("tolerance-memory", bpo::value< double >()->default_value(0.10), "Maximal relative increase of the peak memory")
+			("tolerance-ser", bpo::value< double >()->default_value(0.05), "Maximal absolute increase of the switch error rate [in %]");
+
+	bpo::options_description opt_output ("Output files");
+	opt_output.add_options()
+			("output,O", bpo::value< string >(), "Measures of this run, in the baseline file format")
+			("log", bpo::value< string >(), "Log file");
+
+	descriptions.add(opt_base).add(opt_binary).add(opt_runs).add(opt_gate).add(opt_output);
+}
+
+void driver::parse_command_line(vector < string > & args) {
+	try {
+		bpo::store(bpo::command_line_parser(args).options(descriptions).run(), options);
+		bpo::notify(options);
+	} catch ( const boost::program_options::error& e ) { cerr << "Error parsing command line arguments: " << string(e.what()) << endl; exit(0); }
+
+	if (options.count("help")) { cout << descriptions << endl; exit(0); }
+
+	if (options.count("log") && !vrb.open_log(options["log"].as < string > ()))
+		vrb.error("Impossible to create log file [" + options["log"].as < string > () +"]");
+
+	vrb.title("PHASEBENCH");
+	vrb.bullet("Author        : Olivier DELANEAU, University of Lausanne");
+	vrb.bullet("Contact       : olivier.delaneau@gmail.com");
+	vrb.bullet("Version       : 1.0.0");
+	vrb.bullet("Run date      : " + tac.date());
+}
+
+void driver::check_options() {
+	if (!options.count("output") && !options.count("baseline"))
+		vrb.error("You must specify --output to record a baseline and/or --baseline to compare against one");
+
+	if (options.count("seed") && options["seed"].as < int > () < 0)
+		vrb.error("Random number generator needs a positive seed value");
+
+	if (options["thread"].as < int > () < 1)
+		vrb.error("You must use at least 1 thread");
+
+	if (options["n-samples"].as < int > () < 10)
+		vrb.error("You must simulate at least 10 individuals using --n-samples");
+
+	if (options["tolerance-time"].as < double > () < 0.0 || options["tolerance-memory"].as < double > () < 0.0 || options["tolerance-ser"].as < double > () < 0.0)
+		vrb.error("Tolerances cannot be negative");
+}
+
+void driver::verbose_files() {
+	vrb.title("Files:");
+	vrb.bullet("Phasing binary: [" + options["shapeit"].as < string > () + "]");
+	vrb.bullet("Simulator     : [" + options["simcohort"].as < string > () + "]");
+	vrb.bullet("Work directory: [" + options["work"].as < string > () + "]");
+	if (options.count("baseline")) vrb.bullet("Input BASELINE: [" + options["baseline"].as < string > () + "]");
+	if (options.count("output")) vrb.bullet("Output REPORT : [" + options["output"].as < string > () + "]");
+	if (options.count("log")) vrb.bullet("Output LOG    : [" + options["log"].as < string > () + "]");
+}
+
+void driver::verbose_options() {
+	vrb.title("Parameters:");
+	vrb.bullet("Seed    : " + stb.str(options["seed"].as < int > ()));
+	vrb.bullet("Threads : " + stb.str(options["thread"].as < int > ()) + " threads");
+	vrb.bullet("Configs : " + (options.count("configs")?options["configs"].as < string > ():string("all")));
+	if (options.count("baseline")) vrb.bullet("Gate    : time +" + stb.str(options["tolerance-time"].as < double > () * 100, 1) + "% / memory +" + stb.str(options["tolerance-memory"].as < double > () * 100, 1) + "% / SER +" + stb.str(options["tolerance-ser"].as < double > (), 3) + "%");
+}
@@ -0,0 +1,102 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+#include <evaluation/switch_error.h>
+
+switch_error::switch_error() {
+	n_switches = n_pairs = n_sites = 0;
+	n_samples = n_excluded = 0;
+}
+
+switch_error::~switch_error() {
+}
+
+//Samples of fexcluded [e.g. a scaffold, whose phase is an input] are left out of the evaluation
+void switch_error::compute(string ftruth, string fphased, string region, int nthreads, string fexcluded) {
+	tac.clock();
+	n_switches = n_pairs = n_sites = 0;
+	bcf_srs_t * sr =  bcf_sr_init();
+	if (nthreads > 1) bcf_sr_set_threads(sr, nthreads);
+	sr->collapse = COLLAPSE_NONE;
+	sr->require_index = 1;
+	if (bcf_sr_set_regions(sr, region.c_str(), 0) == -1) vrb.error("Impossible to jump to region [" + region + "]");
+	if (!bcf_sr_add_reader(sr, ftruth.c_str())) vrb.error("Impossible to open truth haplotypes [" + ftruth + "]");
+	if (!bcf_sr_add_reader(sr, fphased.c_str())) vrb.error("Impossible to open phased haplotypes [" + fphased + "]");
+
+	//Samples excluded
+	set < string > Excluded;
+	if (!fexcluded.empty()) {
+		htsFile * fp = hts_open(fexcluded.c_str(), "r");
+		if (!fp) vrb.error("Impossible to open excluded haplotypes [" + fexcluded + "]");
+		bcf_hdr_t * hdr = bcf_hdr_read(fp);
+		if (!hdr) vrb.error("Impossible to read the header of [" + fexcluded + "]");
+		for (int i = 0 ; i < bcf_hdr_nsamples(hdr) ; i ++) Excluded.insert(string(hdr->samples[i]));
+		bcf_hdr_destroy(hdr);
+		hts_close(fp);
+	}
+
+	//Samples matched by name
+	bcf_hdr_t * hdr_truth = sr->readers[0].header;
+	bcf_hdr_t * hdr_phased = sr->readers[1].header;
+	vector < int > idx_truth, idx_phased;
+	n_excluded = 0;
+	for (int i = 0 ; i < bcf_hdr_nsamples(hdr_phased) ; i ++) {
+		int t = bcf_hdr_id2int(hdr_truth, BCF_DT_SAMPLE, hdr_phased->samples[i]);
+		if (t >= 0 && Excluded.count(string(hdr_phased->samples[i]))) n_excluded ++;
+		else if (t >= 0) {
+			idx_truth.push_back(t);
+			idx_phased.push_back(i);
+		}
+	}
+	n_samples = idx_truth.size();
+	if (!n_samples) vrb.error("No sample in common between [" + ftruth + "] and [" + fphased + "]");
+
+	//Orientation of the previous het of each sample: -1 for none, 0 when phased as the truth, 1 when flipped
+	vector < char > Orientation = vector < char > (n_samples, -1);
+	int ngt_truth, * gt_arr_truth = NULL, ngt_arr_truth = 0;
+	int ngt_phased, * gt_arr_phased = NULL, ngt_arr_phased = 0;
+	while (bcf_sr_next_line(sr)) {
+		if (!bcf_sr_has_line(sr, 0) || !bcf_sr_has_line(sr, 1)) continue;
+		bcf1_t * line_truth = bcf_sr_get_line(sr, 0);
+		bcf1_t * line_phased = bcf_sr_get_line(sr, 1);
+		if (line_truth->n_allele != 2 || line_phased->n_allele != 2) continue;
+		ngt_truth = bcf_get_genotypes(hdr_truth, line_truth, &gt_arr_truth, &ngt_arr_truth);
+		ngt_phased = bcf_get_genotypes(hdr_phased, line_phased, &gt_arr_phased, &ngt_arr_phased);
+		if (ngt_truth != 2 * bcf_hdr_nsamples(hdr_truth) || ngt_phased != 2 * bcf_hdr_nsamples(hdr_phased)) continue;
+		for (int i = 0 ; i < n_samples ; i ++) {
+			int t0 = gt_arr_truth[2*idx_truth[i]+0], t1 = gt_arr_truth[2*idx_truth[i]+1];
+			int p0 = gt_arr_phased[2*idx_phased[i]+0], p1 = gt_arr_phased[2*idx_phased[i]+1];
+			if (bcf_gt_is_missing(t0) || bcf_gt_is_missing(t1) || bcf_gt_is_missing(p0) || bcf_gt_is_missing(p1)) continue;
+			if (bcf_gt_allele(t0) == bcf_gt_allele(t1) || bcf_gt_allele(p0) == bcf_gt_allele(p1)) continue;
+			char orientation = (bcf_gt_allele(t0) != bcf_gt_allele(p0));
+			if (Orientation[i] >= 0) {
+				n_switches += (orientation != Orientation[i]);
+				n_pairs ++;
+			}
+			Orientation[i] = orientation;
+		}
+		n_sites ++;
+	}
+	free(gt_arr_truth);
+	free(gt_arr_phased);
+	bcf_sr_destroy(sr);
+	vrb.bullet("Switch errors [N=" + stb.str(n_samples) + (n_excluded?(" / excluded=" + stb.str(n_excluded)):"") + " / L=" + stb.str(n_sites) + " / SER=" + stb.str(rate(), 3) + "%] (" + stb.str(tac.rel_time()*1.0/1000, 2) + "s)");
+}
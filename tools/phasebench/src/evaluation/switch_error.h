@@ -0,0 +1,51 @@
+/*******************************************************************************
+ * Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+#ifndef _SWITCH_ERROR_H
+#define _SWITCH_ERROR_H
+
+#include <utils/otools.h>
+
+//Switch errors of phased haplotypes against the truth, over the hets shared by both files
+class switch_error {
+public:
+	//DATA
+	unsigned long n_switches;		// #switches between consecutive hets
+	unsigned long n_pairs;			// #pairs of consecutive hets evaluated
+	unsigned long n_sites;			// #sites in common
+	unsigned int n_samples;			// #samples in common and evaluated
+	unsigned int n_excluded;		// #samples in common but excluded
+
+	//CONSTRUCTOR/DESTRUCTOR
+	switch_error();
+	~switch_error();
+
+	//METHODS
+	void compute(string, string, string, int, string fexcluded = "");
+	double rate();
+};
+
+inline
+double switch_error::rate() {
+	return n_pairs?(n_switches * 100.0 / n_pairs):0.0;
+}
+
+#endif
@@ -0,0 +1,67 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+#include <io/baseline_file.h>
+
+#define BASELINE_HEADER	"config\twall_s\tmax_rss_mb\tswitch_error\tn_pairs"
+
+baseline_file::baseline_file() {
+}
+
+baseline_file::~baseline_file() {
+	Records.clear();
+}
+
+void baseline_file::read(string fname) {
+	tac.clock();
+	string buffer;
+	vector < string > tokens;
+	input_file fd (fname);
+	if (fd.fail()) vrb.error("Impossible to open baseline file [" + fname + "]");
+	Records.clear();
+	while (getline(fd, buffer)) {
+		if (buffer.empty() || buffer == BASELINE_HEADER) continue;
+		if (stb.split(buffer, tokens) != 5) vrb.error("Baseline file [" + fname + "] needs 5 columns: " + string(BASELINE_HEADER));
+		run_record r;
+		r.config = tokens[0];
+		r.wall = atof(tokens[1].c_str());
+		r.max_rss = atof(tokens[2].c_str());
+		r.ser = atof(tokens[3].c_str());
+		r.n_pairs = atol(tokens[4].c_str());
+		Records.push_back(r);
+	}
+	fd.close();
+	vrb.bullet("Baseline reading [n=" + stb.str(Records.size()) + "] (" + stb.str(tac.rel_time()*1.0/1000, 2) + "s)");
+}
+
+void baseline_file::write(string fname) {
+	output_file fd (fname);
+	if (fd.fail()) vrb.error("Impossible to create file [" + fname + "]");
+	fd << BASELINE_HEADER << endl;
+	for (int r = 0 ; r < Records.size() ; r ++)
+		fd << Records[r].config << "\t" << stb.str(Records[r].wall, 2) << "\t" << stb.str(Records[r].max_rss, 1) << "\t" << stb.str(Records[r].ser, 4) << "\t" << Records[r].n_pairs << endl;
+	fd.close();
+}
+
+int baseline_file::find(string config) {
+	for (int r = 0 ; r < Records.size() ; r ++) if (Records[r].config == config) return r;
+	return -1;
+}
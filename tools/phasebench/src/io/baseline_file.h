@@ -0,0 +1,52 @@
+/*******************************************************************************
+ * Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+#ifndef _BASELINE_FILE_H
+#define _BASELINE_FILE_H
+
+#include <utils/otools.h>
+
+//Measures of one configuration of the regression benchmark
+struct run_record {
+	string config;
+	double wall;			// Wall clock time in seconds
+	double max_rss;			// Peak resident memory in Mb
+	double ser;				// Switch error rate in %
+	unsigned long n_pairs;	// #pairs of consecutive hets the switch error rate is computed on
+};
+
+//TSV file of run records [one line per configuration], used as baseline and as report
+class baseline_file {
+public:
+	//DATA
+	vector < run_record > Records;
+
+	//CONSTRUCTOR/DESTRUCTOR
+	baseline_file();
+	~baseline_file();
+
+	//METHODS
+	void read(string);
+	void write(string);
+	int find(string);
+};
+
+#endif
@@ -0,0 +1,83 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+#include <io/cohort_writer.h>
+
+cohort_writer::cohort_writer() {
+	fp = NULL;
+	hdr = NULL;
+	rec = NULL;
+	n_samples = 0;
+	n_records = 0;
+	nthreads = 1;
+}
+
+cohort_writer::~cohort_writer() {
+	close();
+}
+
+void cohort_writer::open(string _fname, string chr, vector < string > & samples, bool with_ps, int _nthreads) {
+	fname = _fname;
+	nthreads = _nthreads;
+	n_samples = samples.size();
+	n_records = 0;
+	fp = hts_open(fname.c_str(), "wb");
+	if (!fp) vrb.error("Impossible to create BCF file [" + fname + "]");
+	if (nthreads > 1) hts_set_threads(fp, nthreads);
+	hdr = bcf_hdr_init("w");
+	rec = bcf_init1();
+
+	bcf_hdr_append(hdr, string("##fileDate="+tac.date()).c_str());
+	bcf_hdr_append(hdr, "##source=simcohort");
+	bcf_hdr_append(hdr, string("##contig=<ID=" + chr + ">").c_str());
+	bcf_hdr_append(hdr, "##FORMAT=<ID=GT,Number=1,Type=String,Description=\"Genotype\">");
+	if (with_ps) bcf_hdr_append(hdr, "##FORMAT=<ID=PS,Number=1,Type=Integer,Description=\"Phase set\">");
+	for (int i = 0 ; i < n_samples ; i ++) bcf_hdr_add_sample(hdr, samples[i].c_str());
+	bcf_hdr_add_sample(hdr, NULL);
+	if (bcf_hdr_write(fp, hdr) < 0) vrb.error("Failing to write BCF/header [" + fname + "]");
+
+	Genotypes = vector < int > (2 * n_samples, bcf_gt_missing);
+	if (with_ps) PhaseSets = vector < int > (n_samples, bcf_int32_missing);
+}
+
+void cohort_writer::write(string & chr, int pos, string & ref, string & alt, bool with_ps) {
+	bcf_clear1(rec);
+	rec->rid = bcf_hdr_name2id(hdr, chr.c_str());
+	rec->pos = pos - 1;
+	string alleles = ref + "," + alt;
+	bcf_update_alleles_str(hdr, rec, alleles.c_str());
+	bcf_update_genotypes(hdr, rec, Genotypes.data(), 2 * n_samples);
+	if (with_ps) bcf_update_format_int32(hdr, rec, "PS", PhaseSets.data(), n_samples);
+	if (bcf_write1(fp, hdr, rec) < 0) vrb.error("Failing to write BCF/record [" + fname + "]");
+	n_records ++;
+}
+
+void cohort_writer::close() {
+	if (!fp) return;
+	bcf_destroy1(rec);
+	bcf_hdr_destroy(hdr);
+	if (hts_close(fp)) vrb.error("Non zero status when closing BCF file descriptor [" + fname + "]");
+	fp = NULL;
+	hdr = NULL;
+	rec = NULL;
+	if (bcf_index_build3(fname.c_str(), NULL, 14, nthreads) < 0) vrb.error("Failing to index BCF file [" + fname + "]");
+	vrb.bullet("BCF writing [" + fname + " / N=" + stb.str(n_samples) + " / L=" + stb.str(n_records) + "]");
+}
@@ -0,0 +1,57 @@
+/*******************************************************************************
+ * Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+#ifndef _COHORT_WRITER_H
+#define _COHORT_WRITER_H
+
+#include <utils/otools.h>
+
+//One BCF output of the simulated cohort, written site by site and indexed once closed
+class cohort_writer {
+public:
+	//DATA
+	string fname;
+	htsFile * fp;
+	bcf_hdr_t * hdr;
+	bcf1_t * rec;
+	unsigned int n_samples;
+	unsigned long n_records;
+	int nthreads;
+	vector < int > Genotypes;		// 2 entries per sample, to be filled before each call to write
+	vector < int > PhaseSets;		// 1 entry per sample, only written when the site carries phase sets
+
+	//CONSTRUCTOR/DESTRUCTOR
+	cohort_writer();
+	~cohort_writer();
+
+	//METHODS
+	void open(string, string, vector < string > &, bool, int);
+	void write(string &, int, string &, string &, bool);
+	void close();
+	bool isOpen();
+};
+
+inline
+bool cohort_writer::isOpen() {
+	return (fp != NULL);
+}
+
+#endif
@@ -0,0 +1,38 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+#include <simulator/simulator_header.h>
+
+void simulator::write_files_and_finalise() {
+	vrb.title("Finalization:");
+	tac.clock();
+	outTarget.close();
+	outTruth.close();
+	outScaffold.close();
+	outReference.close();
+	fdMap->close();
+	vrb.bullet("MAP writing [" + options["output"].as < string > () + ".gmap.gz]");
+
+	unsigned long n_geno = (n_sites_common + n_sites_rare) * n_target;
+	vrb.bullet("Genotypes [het=" + stb.str(n_geno_het * 100.0 / n_geno, 2) + "% / missing=" + stb.str(n_geno_mis * 100.0 / n_geno, 2) + "% / hets in PS=" + stb.str(n_geno_ps * 100.0 / max(n_geno_het, 1UL), 2) + "%]");
+	vrb.bullet("Indexing and closing (" + stb.str(tac.rel_time()*1.0/1000, 2) + "s)");
+	vrb.bullet("Total running time = " + stb.str(tac.abs_time()) + " seconds");
+}
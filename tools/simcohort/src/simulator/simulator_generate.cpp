@@ -0,0 +1,245 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+#include <simulator/simulator_header.h>
+
+void simulator::openOutputs() {
+	string prefix = options["output"].as < string > ();
+	int nthreads = options["thread"].as < int > ();
+	vector < string > samples_target, samples_scaffold, samples_reference;
+	for (int i = 0 ; i < n_target ; i ++) samples_target.push_back("SAMPLE" + stb.str(i + 1));
+	for (int i = 0 ; i < n_scaffold ; i ++) samples_scaffold.push_back(samples_target[i]);
+	for (int i = 0 ; i < n_reference ; i ++) samples_reference.push_back("REFERENCE" + stb.str(i + 1));
+	outTarget.open(prefix + ".bcf", chr, samples_target, rate_ps > 0.0, nthreads);
+	outTruth.open(prefix + ".truth.bcf", chr, samples_target, false, nthreads);
+	if (n_scaffold) outScaffold.open(prefix + ".scaffold.bcf", chr, samples_scaffold, false, nthreads);
+	if (n_reference) outReference.open(prefix + ".reference.bcf", chr, samples_reference, false, nthreads);
+}
+
+void simulator::generate() {
+	vrb.title("Simulation:");
+	tac.clock();
+	int pos = 0;
+	string ref, alt;
+	if (!sr) {
+		openOutputs();
+		for (unsigned long l = 0 ; l < n_sites_target ; l ++) {
+			nextDenovoSite(pos, ref, alt);
+			double cm = geneticPosition(pos);
+			updateCopying(cm);
+			if (rng.getDouble() < rate_rare) rareSite();
+			else {
+				updateAncestors(cm, rng.getDouble(COMMON_MIN_FREQ, freq_max));
+				updateFounders(cm);
+				commonSite();
+			}
+			writeSite(pos, cm, ref, alt);
+			vrb.progress("  * Simulation", (l+1)*1.0/n_sites_target);
+		}
+	} else {
+		string rare_ref, rare_alt;
+		while (nextPanelSite(pos, ref, alt)) {
+			if (!outTarget.isOpen()) openOutputs();
+
+			//Rare variants are added in the gap preceding each site of the seed panel
+			unsigned int n_rare = 0;
+			while (rng.getDouble() < rate_rare) n_rare ++;
+			if (prev_pos == 0) n_rare = 0;
+			n_rare = min(n_rare, (unsigned int)(pos - prev_pos - 1));
+			set < int > rare_pos;
+			while (rare_pos.size() < n_rare) rare_pos.insert(prev_pos + 1 + rng.getInt(pos - prev_pos - 1));
+			for (set < int > :: iterator it = rare_pos.begin() ; it != rare_pos.end() ; ++it) {
+				double cm = geneticPosition(*it);
+				updateCopying(cm);
+				rareSite();
+				randomAlleles(rare_ref, rare_alt);
+				writeSite(*it, cm, rare_ref, rare_alt);
+			}
+
+			double cm = geneticPosition(pos);
+			updateCopying(cm);
+			commonSite();
+			writeSite(pos, cm, ref, alt);
+			prev_pos = pos;
+		}
+		if (!outTarget.isOpen()) vrb.error("No bi-allelic variant site found in the seed panel");
+	}
+	vrb.bullet("Simulation [common=" + stb.str(n_sites_common) + " / rare=" + stb.str(n_sites_rare) + "] (" + stb.str(tac.rel_time()*1.0/1000, 2) + "s)");
+}
+
+bool simulator::nextPanelSite(int & pos, string & ref, string & alt) {
+	while (bcf_sr_next_line(sr)) {
+		bcf1_t * line = bcf_sr_get_line(sr, 0);
+		if (line->n_allele != 2) continue;
+		bcf_unpack(line, BCF_UN_STR);
+		string line_chr = bcf_hdr_id2name(sr->readers[0].header, line->rid);
+		if (chr.empty()) chr = line_chr;
+		else if (line_chr != chr) continue;
+		if (line->pos + 1 <= prev_pos) continue;
+		int ngt = bcf_get_genotypes(sr->readers[0].header, line, &gt_arr, &ngt_arr);
+		if (ngt != n_founders) continue;
+		for (int f = 0 ; f < n_founders ; f ++) Founders[f] = (bcf_gt_allele(gt_arr[f]) == 1);
+		pos = line->pos + 1;
+		ref = string(line->d.allele[0]);
+		alt = string(line->d.allele[1]);
+		return true;
+	}
+	return false;
+}
+
+void simulator::nextDenovoSite(int & pos, string & ref, string & alt) {
+	//Gaps between sites are exponential with the mean giving the requested region length
+	pos = prev_pos + 1 + (int)floor(-log(1.0 - rng.getDouble()) * (mean_gap - 1));
+	prev_pos = pos;
+	randomAlleles(ref, alt);
+}
+
+double simulator::geneticPosition(int pos) {
+	//Recombination rates are drawn independently for each bin [exponential around the average rate]
+	while (pos >= (map_bin + 1) * MAP_BIN_SIZE) {
+		map_bin_cm += map_bin_rate * MAP_BIN_SIZE / 1e6;
+		map_bin_rate = -log(1.0 - rng.getDouble()) * cm_per_mb;
+		map_bin ++;
+	}
+	return map_bin_cm + map_bin_rate * (pos - map_bin * MAP_BIN_SIZE) / 1e6;
+}
+
+void simulator::updateAncestors(double cm, double freq) {
+	//Ancestors are slowly reordered along the chromosome: alleles carried by runs of consecutive ancestors are then in LD over short distances
+	unsigned int n_moves = (unsigned int)floor((cm - ancestor_cm) * ANCESTOR_MOVES + rng.getDouble());
+	for (unsigned int m = 0 ; m < min(n_moves, (unsigned int)N_ANCESTORS) ; m ++) {
+		unsigned int from = rng.getInt(N_ANCESTORS), to = rng.getInt(N_ANCESTORS), a = AncestorOrder[from];
+		AncestorOrder.erase(AncestorOrder.begin() + from);
+		AncestorOrder.insert(AncestorOrder.begin() + to, a);
+	}
+	ancestor_cm = cm;
+	//Carriers form a clade of a balanced tree over the ordering [power of 2 ancestors], so that alleles are nested as along a genealogy
+	unsigned int n_carriers = 1U << (unsigned int)max(0.0, round(log2(freq * N_ANCESTORS)));
+	unsigned int start = rng.getInt(N_ANCESTORS / n_carriers) * n_carriers;
+	fill(Ancestors.begin(), Ancestors.end(), 0);
+	for (unsigned int a = start ; a < start + n_carriers ; a ++) Ancestors[AncestorOrder[a]] = 1;
+}
+
+void simulator::updateFounders(double cm) {
+	double rate = 0.04 * options["effective-size"].as < int > () / N_ANCESTORS;
+	for (int f = 0 ; f < n_founders ; f ++) {
+		if (cm >= FounderNextSwitch[f]) {
+			FounderCopied[f] = rng.getInt(N_ANCESTORS);
+			FounderNextSwitch[f] = cm - log(1.0 - rng.getDouble()) / rate;
+		}
+		Founders[f] = Ancestors[FounderCopied[f]];
+	}
+}
+
+void simulator::updateCopying(double cm) {
+	//Switches are memoryless: a single draw at the first site past the switch point gives the right copying state
+	for (unsigned long h = 0 ; h < n_hap ; h ++) {
+		if (cm >= NextSwitch[h]) {
+			Copied[h] = rng.getInt(n_founders);
+			NextSwitch[h] = cm - log(1.0 - rng.getDouble()) / rate_switch;
+		}
+	}
+}
+
+void simulator::commonSite() {
+	for (unsigned long h = 0 ; h < n_hap ; h ++) Alleles[h] = Founders[Copied[h]];
+	unsigned long h = 0;
+	while (next_mutation < n_hap - h) {
+		h += next_mutation;
+		Alleles[h] = !Alleles[h];
+		h ++;
+		next_mutation = skip(rate_mutation);
+	}
+	next_mutation -= (n_hap - h);
+	n_sites_common ++;
+}
+
+void simulator::rareSite() {
+	//Carriers share the background of one founder, their number follows a 1/c spectrum
+	fill(Alleles.begin(), Alleles.end(), 0);
+	unsigned int f = Copied[rng.getInt(n_hap)];
+	Carriers.clear();
+	for (unsigned long h = 0 ; h < n_hap ; h ++) if (Copied[h] == f) Carriers.push_back(h);
+	unsigned int c_max = max(1U, min((unsigned int)Carriers.size(), (unsigned int)(RARE_MAX_FREQ * n_hap)));
+	unsigned int c = max(1U, min(c_max, (unsigned int)floor(exp(rng.getDouble() * log(c_max + 1.0)))));
+	for (unsigned int k = 0 ; k < c ; k ++) {
+		swap(Carriers[k], Carriers[k + rng.getInt(Carriers.size() - k)]);
+		Alleles[Carriers[k]] = 1;
+	}
+	n_sites_rare ++;
+}
+
+void simulator::writeSite(int pos, double cm, string & ref, string & alt) {
+	//Truth, scaffold and reference haplotypes
+	for (int i = 0 ; i < n_target ; i ++) {
+		outTruth.Genotypes[2*i+0] = bcf_gt_phased(Alleles[2*i+0]);
+		outTruth.Genotypes[2*i+1] = bcf_gt_phased(Alleles[2*i+1]);
+	}
+	outTruth.write(chr, pos, ref, alt, false);
+	if (outScaffold.isOpen()) {
+		copy(outTruth.Genotypes.begin(), outTruth.Genotypes.begin() + 2 * n_scaffold, outScaffold.Genotypes.begin());
+		outScaffold.write(chr, pos, ref, alt, false);
+	}
+	if (outReference.isOpen()) {
+		for (int i = 0, h = 2 * n_target ; i < n_reference ; i ++, h += 2) {
+			outReference.Genotypes[2*i+0] = bcf_gt_phased(Alleles[h+0]);
+			outReference.Genotypes[2*i+1] = bcf_gt_phased(Alleles[h+1]);
+		}
+		outReference.write(chr, pos, ref, alt, false);
+	}
+
+	//Main genotypes: unphased, with missing data and phase sets
+	bool with_ps = false;
+	for (int i = 0 ; i < n_target ; i ++) {
+		bool a0 = Alleles[2*i+0], a1 = Alleles[2*i+1];
+		bool mi = (next_missing == 0);
+		if (mi) next_missing = skip(rate_missing);
+		else if (next_missing != NO_EVENT) next_missing --;
+		if (mi) {
+			outTarget.Genotypes[2*i+0] = outTarget.Genotypes[2*i+1] = bcf_gt_missing;
+			n_geno_mis ++;
+		} else if (a0 != a1) {
+			if (rate_ps > 0.0 && (PSremaining[i] > 0 || rng.getDouble() < start_ps)) {
+				if (PSremaining[i] == 0) {
+					PScodes[i] = pos;
+					PSremaining[i] = length_ps;
+				}
+				PSremaining[i] --;
+				outTarget.Genotypes[2*i+0] = bcf_gt_unphased(a0);
+				outTarget.Genotypes[2*i+1] = bcf_gt_phased(a1);
+				outTarget.PhaseSets[i] = PScodes[i];
+				with_ps = true;
+				n_geno_ps ++;
+			} else {
+				outTarget.Genotypes[2*i+0] = bcf_gt_unphased(0);
+				outTarget.Genotypes[2*i+1] = bcf_gt_unphased(1);
+			}
+			n_geno_het ++;
+		} else {
+			outTarget.Genotypes[2*i+0] = bcf_gt_unphased(a0);
+			outTarget.Genotypes[2*i+1] = bcf_gt_unphased(a1);
+		}
+	}
+	outTarget.write(chr, pos, ref, alt, with_ps);
+	if (with_ps) fill(outTarget.PhaseSets.begin(), outTarget.PhaseSets.end(), bcf_int32_missing);
+
+	*fdMap << pos << "\t" << chr << "\t" << stb.str(cm, 6) << endl;
+}
@@ -0,0 +1,151 @@
+/*******************************************************************************
+ * Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+#ifndef _SIMULATOR_H
+#define _SIMULATOR_H
+
+#include <utils/otools.h>
+
+#include <io/cohort_writer.h>
+
+#define MAP_BIN_SIZE		10000	// Width in bp of the bins of constant recombination rate
+#define COMMON_MIN_FREQ		0.01	// Lower bound of the founder allele frequency at common variants
+#define RARE_MAX_FREQ		0.01	// Upper bound of the cohort allele frequency at rare variants
+#define N_ANCESTORS			64		// #ancestral haplotypes de novo founders are mosaics of
+#define ANCESTOR_MOVES		500		// Reorderings of the ancestors per cM [sets the decay of LD with distance]
+#define NO_EVENT			std::numeric_limits < unsigned long >::max()
+
+class simulator {
+public:
+	//COMMAND LINE OPTIONS
+	bpo::options_description descriptions;
+	bpo::variables_map options;
+
+	//COHORT
+	string chr;
+	unsigned int n_target, n_reference, n_scaffold;		// #individuals in the main, reference and scaffold sets
+	unsigned long n_hap;								// #simulated haplotypes [main ones first, then reference ones]
+	unsigned int n_founders;							// #haplotypes in the seed panel
+
+	//MODEL PARAMETERS
+	double rate_switch;		// Copying switches per cM [0.04 * Ne / #founders, as in the phasing HMM]
+	double rate_mutation;	// Probability that an allele differs from the copied founder
+	double rate_rare;		// Fraction of rare variants
+	double rate_missing;	// Rate of missing genotypes
+	double rate_ps;			// Fraction of hets carried by a phase set
+	double start_ps;		// Probability that a het starts a new phase set
+	unsigned int length_ps;	// #hets per phase set
+	double freq_max;		// Upper bound of the founder allele frequency at common variants [derived from --het]
+	double cm_per_mb;		// Average recombination rate
+
+	//SEED PANEL [--panel] OR DE NOVO SITES
+	bcf_srs_t * sr;
+	int * gt_arr;
+	int ngt_arr;
+	unsigned long n_sites_target, mean_gap;
+	int prev_pos;
+	vector < char > Founders;			// Alleles of the founders at the current site
+	vector < char > Ancestors;			// Alleles of the ancestors at the current site [de novo only]
+	vector < unsigned int > AncestorOrder;		// Ancestors ordered so that nearby ones share alleles [de novo only]
+	double ancestor_cm;					// Genetic position of the last reordering [de novo only]
+	vector < unsigned int > FounderCopied;		// Ancestor copied by each founder [de novo only]
+	vector < double > FounderNextSwitch;		// Genetic position of the next switch of each founder [de novo only]
+
+	//COPYING STATE
+	vector < unsigned int > Copied;		// Founder copied by each haplotype
+	vector < double > NextSwitch;		// Genetic position of the next switch of each haplotype
+	vector < char > Alleles;			// Simulated alleles at the current site
+	vector < unsigned int > Carriers;	// Buffer for the carriers of rare variants
+	unsigned long next_mutation, next_missing;	// Next events in the flattened haplotype and genotype streams
+
+	//PHASE SETS
+	vector < int > PSremaining, PScodes;
+
+	//GENETIC MAP
+	unsigned long map_bin;
+	double map_bin_cm, map_bin_rate;
+
+	//OUTPUTS
+	cohort_writer outTarget, outTruth, outScaffold, outReference;
+	output_file * fdMap;
+
+	//COUNTS
+	unsigned long n_sites_common, n_sites_rare, n_geno_het, n_geno_mis, n_geno_ps;
+
+	//CONSTRUCTOR
+	simulator();
+	~simulator();
+
+	//PARAMETERS
+	void declare_options();
+	void parse_command_line(vector < string > &);
+	void check_options();
+	void verbose_options();
+	void verbose_files();
+
+	//SIMULATION
+	void simulate(vector < string > &);
+	void read_files_and_initialise();
+	void openOutputs();
+	void generate();
+	bool nextPanelSite(int &, string &, string &);
+	void nextDenovoSite(int &, string &, string &);
+	double geneticPosition(int);
+	void updateAncestors(double, double);
+	void updateFounders(double);
+	void updateCopying(double);
+	void commonSite();
+	void rareSite();
+	void writeSite(int, double, string &, string &);
+	void write_files_and_finalise();
+
+	//HELPERS
+	unsigned long skip(double);
+	double meanHeterozygosity(double);
+	void randomAlleles(string &, string &);
+};
+
+//Number of trials before the next event of probability p [geometric, used to jump over non-events]
+inline
+unsigned long simulator::skip(double p) {
+	if (p <= 0.0) return NO_EVENT;
+	if (p >= 1.0) return 0;
+	double s = floor(log(1.0 - rng.getDouble()) / log(1.0 - p));
+	return (s >= 1e18)?NO_EVENT:(unsigned long)s;
+}
+
+inline
+void simulator::randomAlleles(string & ref, string & alt) {
+	static const char bases [] = "ACGT";
+	unsigned int r = rng.getInt(4), a = (r + 1 + rng.getInt(3)) % 4;
+	ref = string(1, bases[r]);
+	alt = string(1, bases[a]);
+}
+
+//Mean heterozygosity 2p(1-p) for p uniform in [COMMON_MIN_FREQ, b]
+inline
+double simulator::meanHeterozygosity(double b) {
+	double a = COMMON_MIN_FREQ;
+	if (b - a < 1e-9) return 2.0 * a * (1.0 - a);
+	return ((b*b - a*a) - 2.0 * (b*b*b - a*a*a) / 3.0) / (b - a);
+}
+
+#endif
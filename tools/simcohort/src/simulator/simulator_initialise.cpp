@@ -0,0 +1,95 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+#include <simulator/simulator_header.h>
+
+void simulator::read_files_and_initialise() {
+	vrb.title("Initialization:");
+	rng.setSeed(options["seed"].as < int > ());
+	int nthreads = options["thread"].as < int > ();
+	string prefix = options["output"].as < string > ();
+
+	//Seed panel or de novo founders
+	if (options.count("panel")) {
+		sr = bcf_sr_init();
+		if (nthreads > 1) bcf_sr_set_threads(sr, nthreads);
+		if (options.count("region")) {
+			sr->require_index = 1;
+			if (bcf_sr_set_regions(sr, options["region"].as < string > ().c_str(), 0) == -1) vrb.error("Impossible to jump to region [" + options["region"].as < string > () + "]");
+		}
+		if (!bcf_sr_add_reader(sr, options["panel"].as < string > ().c_str())) vrb.error("Impossible to open seed panel [" + options["panel"].as < string > () + "]");
+		n_founders = 2 * bcf_hdr_nsamples(sr->readers[0].header);
+		if (n_founders < 2) vrb.error("Seed panel needs at least one individual");
+		chr = "";
+		vrb.bullet("Seed panel [#founders=" + stb.str(n_founders) + "]");
+	} else {
+		n_founders = options["founders"].as < int > ();
+		chr = options["chr"].as < string > ();
+		n_sites_target = options["n-sites"].as < int > ();
+		mean_gap = (unsigned long)(options["length"].as < double > () * 1e6 / n_sites_target);
+		//Uniform founder frequencies in [COMMON_MIN_FREQ, freq_max] giving the requested mean heterozygosity
+		double target = options["het"].as < double > (), lo = COMMON_MIN_FREQ, hi = 0.5;
+		for (int it = 0 ; it < 64 ; it ++) {
+			double mid = (lo + hi) / 2.0;
+			if (meanHeterozygosity(mid) < target) lo = mid;
+			else hi = mid;
+		}
+		freq_max = (lo + hi) / 2.0;
+		Ancestors = vector < char > (N_ANCESTORS, 0);
+		AncestorOrder = vector < unsigned int > (N_ANCESTORS, 0);
+		for (int a = 0 ; a < N_ANCESTORS ; a ++) AncestorOrder[a] = a;
+		ancestor_cm = 0.0;
+		FounderCopied = vector < unsigned int > (n_founders, 0);
+		FounderNextSwitch = vector < double > (n_founders, -1.0);
+		vrb.bullet("De novo founders [#founders=" + stb.str(n_founders) + " / max freq=" + stb.str(freq_max, 3) + "]");
+	}
+	Founders = vector < char > (n_founders, 0);
+
+	//Copying model
+	n_target = options["n-samples"].as < int > ();
+	n_reference = options["n-reference"].as < int > ();
+	n_scaffold = (unsigned int)round(options["scaffold"].as < double > () * n_target);
+	n_hap = 2UL * (n_target + n_reference);
+	rate_switch = 0.04 * options["effective-size"].as < int > () / n_founders;
+	rate_mutation = options["mutation"].as < double > ();
+	rate_rare = options["rare"].as < double > ();
+	rate_missing = options["missing"].as < double > ();
+	rate_ps = options["ps-rate"].as < double > ();
+	length_ps = options["ps-length"].as < int > ();
+	start_ps = (rate_ps >= 1.0)?1.0:(rate_ps / (length_ps - rate_ps * length_ps + rate_ps));
+	cm_per_mb = options["cm-per-mb"].as < double > ();
+	Copied = vector < unsigned int > (n_hap, 0);
+	NextSwitch = vector < double > (n_hap, -1.0);
+	Alleles = vector < char > (n_hap, 0);
+	next_mutation = skip(rate_mutation);
+	next_missing = skip(rate_missing);
+	PSremaining = vector < int > (n_target, 0);
+	PScodes = vector < int > (n_target, 0);
+	map_bin = 0;
+	map_bin_cm = 0.0;
+	map_bin_rate = -log(1.0 - rng.getDouble()) * cm_per_mb;
+	vrb.bullet("Copying model [#haplotypes=" + stb.str(n_hap) + " / switches=" + stb.str(rate_switch, 2) + " per cM]");
+
+	//Outputs are opened once the chromosome name is known [first site of the seed panel]
+	fdMap = new output_file (prefix + ".gmap.gz");
+	if (fdMap->fail()) vrb.error("Impossible to create genetic map [" + prefix + ".gmap.gz]");
+	*fdMap << "pos\tchr\tcM" << endl;
+}
@@ -0,0 +1,50 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+#include <simulator/simulator_header.h>
+
+simulator::simulator() {
+	sr = NULL;
+	gt_arr = NULL;
+	ngt_arr = 0;
+	fdMap = NULL;
+	n_target = n_reference = n_scaffold = n_founders = 0;
+	n_hap = n_sites_target = mean_gap = 0;
+	n_sites_common = n_sites_rare = n_geno_het = n_geno_mis = n_geno_ps = 0;
+	prev_pos = 0;
+}
+
+simulator::~simulator() {
+	if (sr) bcf_sr_destroy(sr);
+	if (gt_arr) free(gt_arr);
+	if (fdMap) delete fdMap;
+}
+
+void simulator::simulate(vector < string > & args) {
+	declare_options();
+	parse_command_line(args);
+	check_options();
+	verbose_files();
+	verbose_options();
+	read_files_and_initialise();
+	generate();
+	write_files_and_finalise();
+}
@@ -0,0 +1,157 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2018 Olivier Delaneau, University of Lausanne
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+// 
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+////////////////////////////////////////////////////////////////////////////////
+#include <simulator/simulator_header.h>
+
+void simulator::declare_options() {
+	bpo::options_description opt_base ("Basic options");
+	opt_base.add_options()
+			("help", "Produce help message")
+			("seed", bpo::value<int>()->default_value(15052011), "Seed of the random number generator")
+			("thread,T", bpo::value<int>()->default_value(1), "Number of thread used for BCF compression");
+
+	bpo::options_description opt_input ("Seed panel");
+	opt_input.add_options()
+			("panel,P", bpo::value< string >(), "Phased haplotypes in VCF/BCF format used as founders [sites and alleles are then taken from it]")
+			("region,R", bpo::value< string >(), "Region of the seed panel to use")
+			("founders", bpo::value< int >()->default_value(100), "Number of founder haplotypes simulated when no seed panel is given");
+
+	bpo::options_description opt_cohort ("Cohort");
+	opt_cohort.add_options()
+			("n-samples,N", bpo::value< int >()->default_value(1000), "Number of individuals to simulate")
+			("n-reference", bpo::value< int >()->default_value(0), "Number of individuals to simulate in a reference panel")
+			("scaffold", bpo::value< double >()->default_value(0.0), "Fraction of individuals written in a scaffold of haplotypes")
+			("chr", bpo::value< string >()->default_value("1"), "Chromosome name [without seed panel]")
+			("n-sites,L", bpo::value< int >()->default_value(100000), "Number of variant sites [without seed panel]")
+			("length", bpo::value< double >()->default_value(10.0), "Length of the simulated region in Mb [without seed panel]");
+
+	bpo::options_description opt_model ("Copying model");
+	opt_model.add_options()
+			("effective-size", bpo::value< int >()->default_value(15000), "Effective size of the population")
+			("cm-per-mb", bpo::value< double >()->default_value(1.0), "Average recombination rate [rates vary across 10kb bins]")
+			("mutation", bpo::value< double >()->default_value(0.001), "Probability that a copied allele mutates")
+			("het", bpo::value< double >()->default_value(0.15), "Mean heterozygosity at common variants [without seed panel]")
+			("rare", bpo::value< double >()->default_value(0.5), "Fraction of rare variants [allele frequency below 1%]");
+
+	bpo::options_description opt_geno ("Genotypes");
+	opt_geno.add_options()
+			("missing", bpo::value< double >()->default_value(0.0), "Rate of missing genotypes")
+			("ps-rate", bpo::value< double >()->default_value(0.0), "Fraction of hets phased by read based phasing [PS field]")
+			("ps-length", bpo::value< int >()->default_value(5), "Number of hets per phase set");
+
+	bpo::options_description opt_output ("Output files");
+	opt_output.add_options()
+			("output,O", bpo::value< string >(), "Prefix of the output files [.bcf / .truth.bcf / .scaffold.bcf / .reference.bcf / .gmap.gz]")
+			("log", bpo::value< string >(), "Log file");
+
+	descriptions.add(opt_base).add(opt_input).add(opt_cohort).add(opt_model).add(opt_geno).add(opt_output);
+}
+
+void simulator::parse_command_line(vector < string > & args) {
+	try {
+		bpo::store(bpo::command_line_parser(args).options(descriptions).run(), options);
+		bpo::notify(options);
+	} catch ( const boost::program_options::error& e ) { cerr << "Error parsing command line arguments: " << string(e.what()) << endl; exit(0); }
+
+	if (options.count("help")) { cout << descriptions << endl; exit(0); }
+
+	if (options.count("log") && !vrb.open_log(options["log"].as < string > ()))
+		vrb.error("Impossible to create log file [" + options["log"].as < string > () +"]");
+
+	vrb.title("SIMCOHORT");
+	vrb.bullet("Author        : Olivier DELANEAU, University of Lausanne");
+	vrb.bullet("Contact       : olivier.delaneau@gmail.com");
+	vrb.bullet("Version       : 1.0.0");
+	vrb.bullet("Run date      : " + tac.date());
+}
+
+void simulator::check_options() {
+	if (!options.count("output"))
+		vrb.error("You must specify a prefix for the output files using --output");
+
+	if (options.count("seed") && options["seed"].as < int > () < 0)
+		vrb.error("Random number generator needs a positive seed value");
+
+	if (options["n-samples"].as < int > () < 1)
+		vrb.error("You must simulate at least one individual using --n-samples");
+
+	if (options["n-reference"].as < int > () < 0)
+		vrb.error("The number of reference individuals cannot be negative");
+
+	if (!options.count("panel") && options["founders"].as < int > () < 2)
+		vrb.error("You must simulate at least 2 founders using --founders");
+
+	if (!options.count("panel") && options["n-sites"].as < int > () < 1)
+		vrb.error("You must simulate at least one site using --n-sites");
+
+	if (!options.count("panel") && options["length"].as < double > () * 1e6 < options["n-sites"].as < int > ())
+		vrb.error("The region given by --length is too short for the number of sites given by --n-sites");
+
+	if (options.count("region") && !options.count("panel"))
+		vrb.error("--region only applies to a seed panel given with --panel");
+
+	if (options["het"].as < double > () < meanHeterozygosity(COMMON_MIN_FREQ) || options["het"].as < double > () > meanHeterozygosity(0.5))
+		vrb.error("--het needs to be in [" + stb.str(meanHeterozygosity(COMMON_MIN_FREQ), 3) + "," + stb.str(meanHeterozygosity(0.5), 3) + "]");
+
+	if (options["scaffold"].as < double > () < 0.0 || options["scaffold"].as < double > () > 1.0)
+		vrb.error("--scaffold needs to be in [0,1]");
+
+	if (options["rare"].as < double > () < 0.0 || options["rare"].as < double > () >= 1.0)
+		vrb.error("--rare needs to be in [0,1)");
+
+	if (options["mutation"].as < double > () < 0.0 || options["mutation"].as < double > () >= 0.5)
+		vrb.error("--mutation needs to be in [0,0.5)");
+
+	if (options["missing"].as < double > () < 0.0 || options["missing"].as < double > () >= 1.0)
+		vrb.error("--missing needs to be in [0,1)");
+
+	if (options["ps-rate"].as < double > () < 0.0 || options["ps-rate"].as < double > () > 1.0)
+		vrb.error("--ps-rate needs to be in [0,1]");
+
+	if (options["ps-length"].as < int > () < 2)
+		vrb.error("--ps-length needs to be at least 2");
+
+	if (options["cm-per-mb"].as < double > () <= 0.0)
+		vrb.error("--cm-per-mb needs to be positive");
+}
+
+void simulator::verbose_files() {
+	string prefix = options["output"].as < string > ();
+	vrb.title("Files:");
+	if (options.count("panel")) vrb.bullet("Seed panel    : [" + options["panel"].as < string > () + "]");
+	vrb.bullet("Output BCF    : [" + prefix + ".bcf]");
+	vrb.bullet("Output truth  : [" + prefix + ".truth.bcf]");
+	if (options["scaffold"].as < double > () > 0.0) vrb.bullet("Output SCAF   : [" + prefix + ".scaffold.bcf]");
+	if (options["n-reference"].as < int > () > 0) vrb.bullet("Output REF    : [" + prefix + ".reference.bcf]");
+	vrb.bullet("Output MAP    : [" + prefix + ".gmap.gz]");
+	if (options.count("log")) vrb.bullet("Output LOG    : [" + options["log"].as < string > () + "]");
+}
+
+void simulator::verbose_options() {
+	vrb.title("Parameters:");
+	vrb.bullet("Seed    : " + stb.str(options["seed"].as < int > ()));
+	vrb.bullet("Threads : " + stb.str(options["thread"].as < int > ()) + " threads");
+	vrb.bullet("Cohort  : N=" + stb.str(options["n-samples"].as < int > ()) + " / Nref=" + stb.str(options["n-reference"].as < int > ()) + " / scaffold=" + stb.str(options["scaffold"].as < double > (), 3));
+	if (options.count("panel")) vrb.bullet("Sites   : from seed panel" + (options.count("region")?(" [" + options["region"].as < string > () + "]"):string("")));
+	else vrb.bullet("Sites   : chr=" + options["chr"].as < string > () + " / L=" + stb.str(options["n-sites"].as < int > ()) + " / length=" + stb.str(options["length"].as < double > (), 2) + "Mb / founders=" + stb.str(options["founders"].as < int > ()) + " / het=" + stb.str(options["het"].as < double > (), 3));
+	vrb.bullet("Model   : Ne=" + stb.str(options["effective-size"].as < int > ()) + " / rate=" + stb.str(options["cm-per-mb"].as < double > (), 2) + "cM/Mb / mutation=" + stb.str(options["mutation"].as < double > (), 4) + " / rare=" + stb.str(options["rare"].as < double > (), 3));
+	vrb.bullet("Data    : missing=" + stb.str(options["missing"].as < double > (), 3) + " / PS=" + stb.str(options["ps-rate"].as < double > (), 3) + " x " + stb.str(options["ps-length"].as < int > ()) + " hets");
+}